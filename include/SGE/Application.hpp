@@ -18,6 +18,8 @@
 #include <SGE/Export.hpp>
 
 namespace sge {
+class JobSystem;
+
 /**
  * \brief Abstract base class for applications
  *
@@ -134,6 +136,16 @@ public:
      */
     [[nodiscard]] int getArgCount() const;
 
+    /**
+     * \brief Get job system
+     *
+     *
+     * Get the job system created by the current application, with a worker
+     * thread per hardware thread except for the main one.
+     * \return Job system of the application
+     */
+    [[nodiscard]] static JobSystem& getJobSystem();
+
     [[noreturn]] static void crashApplication(const char* reason);
 
 private:
@@ -161,6 +173,7 @@ private:
 
     const char* const* m_args;
     int m_argc;
+    JobSystem* m_jobSystem;
 };
 }
 
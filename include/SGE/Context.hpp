@@ -18,9 +18,16 @@
 #include <SGE/Export.hpp>
 #include <SGE/Monitor.hpp>
 #include <SGE/ContextSettings.hpp>
+#include <cstdint>
 
 namespace sge {
 class Window;
+class Shader;
+class Texture;
+class VAO;
+class VBO;
+class RenderTarget;
+class TextureStreamer;
 
 /**
  * \brief Object representing an OpenGL context
@@ -123,12 +130,48 @@ public:
      */
     static void setSharedContextCurrent();
 
+    /**
+     * \brief Get number of elided state changes
+     *
+     *
+     * The library keeps a shadow of the OpenGL state it changes (bound
+     * program, vertex array, element buffer, textures, viewport and depth
+     * testing) and skips calls that would not change anything. This
+     * returns how many calls were skipped in this context.
+     * \return Number of elided state changes
+     */
+    [[nodiscard]] std::uint64_t getElidedStateChanges() const;
+
+    /**
+     * \brief Reset the state cache
+     *
+     *
+     * Forgets the cached OpenGL state of this context. Call this after
+     * changing the state through raw OpenGL calls.
+     */
+    void resetStateCache();
+
 private:
     SGE_PRIVATE void create(void* winHandle, const ContextSettings& settings);
+    SGE_PRIVATE void useProgram(unsigned int program);
+    SGE_PRIVATE void bindVertexArray(unsigned int vertexArray);
+    SGE_PRIVATE void bindElementBuffer(unsigned int buffer);
+    SGE_PRIVATE void bindTexture(unsigned int unit, unsigned int texture);
+    SGE_PRIVATE void setViewport(int x, int y, int width, int height);
+    SGE_PRIVATE void setDepthTest(bool enabled);
+    SGE_PRIVATE static void objectDeleted();
     ContextSettings m_settings;
     void* m_handle;
     void* m_windowHandle;
     bool m_sharedWindow;
+    void* m_state;
+
+    friend class Shader;
+    friend class Texture;
+    friend class VAO;
+    friend class VBO;
+    friend class RenderTarget;
+    friend class TextureStreamer;
 };
 }
 
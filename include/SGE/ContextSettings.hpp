@@ -43,28 +43,37 @@ struct SGE_API ContextSettings {
      * \param greenBits Number of green bits
      * \param blueBits Number of blue bits
      * \param alphaBits Number of alpha bits
+     * \param batchSegments Number of fenced segments in a render target's batch ring
+     * \param batchCapacity Number of vertices in one batch segment
+     * \param adaptiveBatching Grow the batch capacity when frames keep overflowing it
      */
-    explicit ContextSettings(bool vsync        = false,
-                             int samples       = 0,
-                             bool debugContext = false,
-                             bool srgbCapable  = false,
-                             int depthBits     = 24,
-                             int stencilBits   = 8,
-                             int redBits       = 8,
-                             int greenBits     = 8,
-                             int blueBits      = 8,
-                             int alphaBits     = 8);
+    explicit ContextSettings(bool vsync                 = false,
+                             int samples                = 0,
+                             bool debugContext          = false,
+                             bool srgbCapable           = false,
+                             int depthBits              = 24,
+                             int stencilBits            = 8,
+                             int redBits                = 8,
+                             int greenBits              = 8,
+                             int blueBits               = 8,
+                             int alphaBits              = 8,
+                             unsigned int batchSegments = 3,
+                             unsigned int batchCapacity = 1000,
+                             bool adaptiveBatching      = false);
 
-    bool vsync;       ///< VSync enabled
-    int samples;      ///< MSAA samples
-    bool debugContext;///< OpenGL debug context
-    bool srgbCapable; ///< SRGB capable context
-    int depthBits;    ///< Number of bits for the depth buffer
-    int stencilBits;  ///< Number of bits for the stencil buffer
-    int redBits;      ///< Number of red bits
-    int greenBits;    ///< Number of green bits
-    int blueBits;     ///< Number of blue bits
-    int alphaBits;    ///< Number of alpha bits
+    bool vsync;                ///< VSync enabled
+    int samples;               ///< MSAA samples
+    bool debugContext;         ///< OpenGL debug context
+    bool srgbCapable;          ///< SRGB capable context
+    int depthBits;             ///< Number of bits for the depth buffer
+    int stencilBits;           ///< Number of bits for the stencil buffer
+    int redBits;               ///< Number of red bits
+    int greenBits;             ///< Number of green bits
+    int blueBits;              ///< Number of blue bits
+    int alphaBits;             ///< Number of alpha bits
+    unsigned int batchSegments;///< Number of fenced batch segments (round-robin)
+    unsigned int batchCapacity;///< Number of vertices in a batch segment
+    bool adaptiveBatching;     ///< Grow batch capacity on repeated overflow
 };
 }
 
@@ -0,0 +1,94 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_IMAGELOADER_HPP
+#define SGE_IMAGELOADER_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+
+namespace sge {
+class Image;
+class JobSystem;
+
+/**
+ * \brief Batch image loader
+ *
+ *
+ * Loads many images at once, reading and decoding them in parallel on a job
+ * system. Each thread reads files through its own InputFile into a buffer it
+ * keeps between files, so a batch needs no per-file allocations besides the
+ * decoded pixels.
+ * Usage example:
+ * \code
+ * const char* paths[] = {"/player.png", "/enemy.png", "/tiles.png"};
+ * sge::Image images[3];
+ * sge::ImageLoader::Timing timings[3];
+ * const auto loaded = sge::ImageLoader::loadAll(paths, 3, images, timings);
+ * \endcode
+ */
+class SGE_API ImageLoader {
+public:
+    /**
+     * \brief Image load timing
+     *
+     *
+     * Time spent loading one image, in milliseconds.
+     */
+    struct Timing {
+        float read;  ///< Time spent reading the file
+        float decode;///< Time spent decoding the image
+    };
+
+    /**
+     * \brief Load images
+     *
+     *
+     * Loads images on the job system of the application and returns once all
+     * are loaded. Images which fail to load are left empty.
+     * \param paths Array of paths to virtual files
+     * \param count Number of paths
+     * \param images Array of images to load, one per path
+     * \param timings Array receiving the timing of each image (can be
+     * nullptr)
+     * \return Number of images loaded successfully
+     */
+    static std::size_t loadAll(const char* const* paths,
+                               std::size_t count,
+                               Image* images,
+                               Timing* timings = nullptr);
+
+    /**
+     * \brief Load images
+     *
+     *
+     * Loads images on a job system and returns once all are loaded. Images
+     * which fail to load are left empty.
+     * \param jobSystem Job system to load the images on
+     * \param paths Array of paths to virtual files
+     * \param count Number of paths
+     * \param images Array of images to load, one per path
+     * \param timings Array receiving the timing of each image (can be
+     * nullptr)
+     * \return Number of images loaded successfully
+     */
+    static std::size_t loadAll(JobSystem& jobSystem,
+                               const char* const* paths,
+                               std::size_t count,
+                               Image* images,
+                               Timing* timings = nullptr);
+};
+}
+
+#endif//SGE_IMAGELOADER_HPP
@@ -0,0 +1,200 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_JOBSYSTEM_HPP
+#define SGE_JOBSYSTEM_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <atomic>
+
+namespace sge {
+/**
+ * \brief Job counter
+ *
+ *
+ * Counts the unfinished jobs submitted with it. A counter can be waited on
+ * with JobSystem::wait, or given as a dependency so jobs start only after all
+ * the jobs of the counter have finished. A counter must outlive its jobs.
+ */
+class SGE_API JobCounter {
+public:
+    /**
+     * \brief Create job counter
+     */
+    JobCounter();
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    /**
+     * \brief Check if the jobs are done
+     * \return True if all the jobs of the counter have finished
+     */
+    [[nodiscard]] bool isDone() const;
+
+private:
+    friend class JobSystem;
+
+    std::atomic<std::uint32_t> m_value;
+};
+
+/**
+ * \brief Job system
+ *
+ *
+ * Runs jobs on a pool of worker threads. Each thread has its own job deque:
+ * it takes jobs from the back of its deque and, once it runs out, steals jobs
+ * from the front of the other deques. A thread waiting for a counter runs
+ * jobs meanwhile instead of blocking. With no worker threads every job runs
+ * on the thread waiting for it, in submission order, which makes results and
+ * timings reproducible. The job system of the application can be retrieved
+ * with Application::getJobSystem.
+ * Usage example:
+ * \code
+ * auto& jobs = sge::Application::getJobSystem();
+ * jobs.parallelFor(particles.size(), 1024,
+ *                  [&](std::size_t begin, std::size_t end) {
+ *                      for (auto i = begin; i < end; i++) {
+ *                          particles[i].update(deltaTime);
+ *                      }
+ *                  });
+ * \endcode
+ */
+class SGE_API JobSystem {
+public:
+    /**
+     * \brief Job function
+     *
+     *
+     * Function running a job over the [begin, end) index range, receiving the
+     * data pointer given when the job was submitted.
+     */
+    using Job = void (*)(void* data, std::size_t begin, std::size_t end);
+
+    /**
+     * \brief Create job system
+     *
+     *
+     * Creates a job system with a worker thread per hardware thread, except
+     * for the one of the calling thread.
+     */
+    JobSystem();
+
+    /**
+     * \brief Create job system
+     * \param workerCount Number of worker threads (0 runs every job on the
+     * waiting thread)
+     */
+    explicit JobSystem(unsigned int workerCount);
+
+    /**
+     * \brief Destroy job system
+     *
+     *
+     * Finishes the queued jobs and joins the worker threads.
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * \brief Submit job
+     * \param job Job function
+     * \param data Data given to the job function
+     * \param begin First index of the range
+     * \param end One past the last index of the range
+     * \param counter Counter of the job (can be nullptr)
+     * \param dependency Counter which must finish before the job starts (can
+     * be nullptr)
+     */
+    void submit(Job job,
+                void* data,
+                std::size_t begin,
+                std::size_t end,
+                JobCounter* counter          = nullptr,
+                const JobCounter* dependency = nullptr);
+
+    /**
+     * \brief Run job over an index range
+     *
+     *
+     * Splits the [0, count) range into jobs of at most grain indices. If a
+     * counter is given the call returns immediately, otherwise it returns once
+     * every job has finished.
+     * \param count Number of indices
+     * \param grain Maximum number of indices per job
+     * \param job Job function
+     * \param data Data given to the job function
+     * \param counter Counter of the jobs (can be nullptr)
+     * \param dependency Counter which must finish before the jobs start (can
+     * be nullptr)
+     */
+    void parallelFor(std::size_t count,
+                     std::size_t grain,
+                     Job job,
+                     void* data,
+                     JobCounter* counter          = nullptr,
+                     const JobCounter* dependency = nullptr);
+
+    /**
+     * \brief Run function over an index range
+     *
+     *
+     * Splits the [0, count) range into jobs of at most grain indices, calling
+     * function(begin, end) for each, and returns once every job has finished.
+     * \param count Number of indices
+     * \param grain Maximum number of indices per job
+     * \param function Function to call
+     */
+    template<typename F>
+    void parallelFor(std::size_t count, std::size_t grain, const F& function);
+
+    /**
+     * \brief Wait for jobs
+     *
+     *
+     * Runs queued jobs until all the jobs of the counter have finished.
+     * \param counter Counter to wait for
+     */
+    void wait(const JobCounter& counter);
+
+    /**
+     * \brief Get worker count
+     * \return Number of worker threads
+     */
+    [[nodiscard]] unsigned int getWorkerCount() const;
+
+private:
+    SGE_PRIVATE void start(unsigned int workerCount);
+
+    void* m_data;
+};
+
+template<typename F>
+void JobSystem::parallelFor(const std::size_t count,
+                            const std::size_t grain,
+                            const F& function) {
+    parallelFor(
+        count,
+        grain,
+        [](void* data, const std::size_t begin, const std::size_t end) {
+            (*static_cast<const F*>(data))(begin, end);
+        },
+        const_cast<void*>(static_cast<const void*>(&function)));
+}
+}
+
+#endif//SGE_JOBSYSTEM_HPP
@@ -0,0 +1,158 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_MIPCHAIN_HPP
+#define SGE_MIPCHAIN_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Resource.hpp>
+#include <glm/vec2.hpp>
+
+namespace sge {
+class Image;
+
+/**
+ * \brief Mipmap chain
+ *
+ *
+ * Holds the RGBA pixels of every mipmap level of an image, generated on the
+ * CPU. Levels are filtered in linear space when the pixels are sRGB encoded,
+ * so downscaled images keep their brightness. A generated chain can be saved
+ * to a native file and loaded back later as a resource, skipping the
+ * filtering, and is uploaded at once with Texture::loadFromMipChain.
+ * Usage example:
+ * \code
+ * sge::MipChain chain;
+ * if (!chain.loadFromFile("/cache/tiles.mip")) {
+ *     chain.generate(sge::Image("/tiles.png"));
+ *     chain.saveToFile("data/cache/tiles.mip");
+ * }
+ * texture.loadFromMipChain(chain);
+ * \endcode
+ */
+class SGE_API MipChain final : public Resource {
+public:
+    /**
+     * \brief Downsampling filter
+     */
+    enum class Filter {
+        Box,  ///< Average of the covered pixels, fastest
+        Kaiser///< Kaiser windowed sinc, keeps detail sharper
+    };
+
+    /**
+     * \brief Create mipmap chain
+     *
+     *
+     * Creates an empty mipmap chain.
+     */
+    MipChain();
+
+    /**
+     * \brief Destroy mipmap chain
+     */
+    ~MipChain() override;
+
+    MipChain(const MipChain&) = delete;
+    MipChain& operator=(const MipChain&) = delete;
+
+    /**
+     * \brief Generate mipmap chain
+     *
+     *
+     * Generates all levels down to 1x1 from RGBA pixels.
+     * \param pixels Pointer to the pixels, 4 bytes each, row by row
+     * \param size Size of the image
+     * \param filter Downsampling filter
+     * \param srgb Whether the color channels are sRGB encoded
+     * \return true on success, false if the image is empty or too large
+     */
+    bool generate(const unsigned char* pixels,
+                  const glm::uvec2& size,
+                  Filter filter = Filter::Kaiser,
+                  bool srgb     = true);
+
+    /**
+     * \brief Generate mipmap chain
+     *
+     *
+     * Generates all levels down to 1x1 from an image.
+     * \param image Image to generate the levels from
+     * \param filter Downsampling filter
+     * \param srgb Whether the color channels are sRGB encoded
+     * \return true on success, false if the image is empty or too large
+     */
+    bool generate(const Image& image,
+                  Filter filter = Filter::Kaiser,
+                  bool srgb     = true);
+
+    /**
+     * \brief Load mipmap chain
+     *
+     *
+     * Loads a mipmap chain saved with saveToFile from a virtual file.
+     * \param path Path to the virtual file
+     * \return true on success, false otherwise
+     */
+    bool loadFromFile(const char* path) override;
+
+    /**
+     * \brief Load mipmap chain
+     *
+     *
+     * Loads a mipmap chain saved with saveToFile from memory. Headers whose
+     * level sizes do not fit in memory are rejected.
+     * \param size Size of the data buffer
+     * \param data Pointer to the data buffer
+     * \return true on success, false otherwise
+     */
+    bool loadFromMemory(std::size_t size, const void* data) override;
+
+    /**
+     * \brief Save mipmap chain
+     *
+     *
+     * Writes the mipmap chain to a native file, as the virtual filesystem is
+     * read only.
+     * \param path Native path of the file
+     * \return true on success, false otherwise
+     */
+    bool saveToFile(const char* path) const;
+
+    /**
+     * \brief Get level count
+     * \return Number of levels, 0 if the chain is empty
+     */
+    [[nodiscard]] unsigned int getLevelCount() const;
+
+    /**
+     * \brief Get level size
+     * \param level Index of the level
+     * \return Size of the level in pixels
+     */
+    [[nodiscard]] glm::uvec2 getLevelSize(unsigned int level) const;
+
+    /**
+     * \brief Get level pixels
+     * \param level Index of the level
+     * \return Pointer to the RGBA pixels of the level
+     */
+    [[nodiscard]] const unsigned char* getLevelPixels(unsigned int level) const;
+
+private:
+    void* m_data;
+};
+}
+
+#endif//SGE_MIPCHAIN_HPP
@@ -0,0 +1,131 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_RENDERCOMMANDLIST_HPP
+#define SGE_RENDERCOMMANDLIST_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <SGE/Vertex.hpp>
+#include <SGE/RenderState.hpp>
+
+namespace sge {
+/**
+ * \brief Render command list
+ *
+ *
+ * Records draws without touching OpenGL, so lists can be filled on worker
+ * threads in parallel. Vertices are transformed while recording and stored
+ * in the list, together with runs of consecutive draws sharing the same
+ * shader, texture and layer. A render target then merges the lists into its
+ * batch on the rendering thread.
+ * Usage example:
+ * \code
+ * // On worker threads
+ * list.clear();
+ * list.drawQuad(vertices, renderState);
+ * // On the rendering thread
+ * window.submit(lists, listCount);
+ * \endcode
+ * \note A list may be used by only one thread at a time.
+ */
+class SGE_API RenderCommandList {
+public:
+    /**
+     * \brief Create command list
+     *
+     *
+     * Creates an empty command list.
+     */
+    RenderCommandList();
+
+    /**
+     * \brief Create command list
+     *
+     *
+     * Move-constructs a command list.
+     * \param other Command list to move
+     */
+    RenderCommandList(RenderCommandList&& other) noexcept;
+
+    ~RenderCommandList();
+
+    /**
+     * \brief Move command list
+     * \param other Command list to move
+     * \return *this
+     */
+    RenderCommandList& operator=(RenderCommandList&& other) noexcept;
+
+    RenderCommandList(const RenderCommandList&) = delete;
+    RenderCommandList& operator=(const RenderCommandList&) = delete;
+
+    /**
+     * \brief Clear the list
+     *
+     *
+     * Removes all recorded draws, keeping the allocated memory.
+     */
+    void clear();
+
+    /**
+     * \brief Record a triangle
+     * \param vertices Pointer to a vertex array with 3 vertices
+     * \param renderState Rendering state
+     */
+    void
+    drawTriangle(const Vertex* vertices,
+                 const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Record a quad
+     * \param vertices Pointer to a vertex array with 4 vertices
+     * \param renderState Rendering state
+     */
+    void drawQuad(const Vertex* vertices,
+                  const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Record quads
+     * \param vertices Pointer to a vertex array with 4 vertices per quad
+     * \param transforms Pointer to an array with a transform per quad, applied
+     * before the state's transform (may be nullptr)
+     * \param count Number of quads
+     * \param renderState Rendering state
+     */
+    void drawQuads(const Vertex* vertices,
+                   const glm::mat4* transforms,
+                   std::size_t count,
+                   const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Get number of recorded quads
+     *
+     *
+     * Returns the number of recorded quads. Triangles are counted as quads.
+     * \return Number of quads
+     */
+    [[nodiscard]] std::size_t getQuadCount() const;
+
+private:
+    SGE_PRIVATE Vertex* append(const RenderState& renderState,
+                               std::size_t quads);
+
+    void* m_data;
+
+    friend class RenderTarget;
+};
+}
+
+#endif//SGE_RENDERCOMMANDLIST_HPP
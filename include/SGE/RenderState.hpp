@@ -27,7 +27,8 @@ class Texture;
  *
  *
  * Object that represents the current state of rendering, such as
- * the currently used shader, texture, etc.
+ * the currently used shader, texture, etc. The layer is only used by
+ * render targets in deferred mode, where draws are sorted by layer first.
  */
 class SGE_API RenderState {
 public:
@@ -54,6 +55,7 @@ public:
     Shader* shader;
     glm::mat4 transform;
     Texture* texture;
+    unsigned char layer;
 };
 }
 
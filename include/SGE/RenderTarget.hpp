@@ -25,20 +25,42 @@
 #include <SGE/VAO.hpp>
 #include <SGE/Vertex.hpp>
 #include <SGE/Shader.hpp>
+#include <SGE/RenderCommandList.hpp>
 #include <glm/vec2.hpp>
 
 namespace sge {
 class Drawable;
 class Window;
+class StaticBatch;
 
 /**
  * \brief Base for render targets
  *
  *
  * This objects serves as a base for all rendering targets, such as windows, textures, etc.
+ *
+ * When GL_ARB_bindless_texture is supported and the batch's shader declares
+ * a TextureHandles storage block at binding 0, textures are passed as
+ * bindless handles instead of texture units. A vertex's texUnit then indexes
+ * that block, and texture changes no longer split batches at the image unit
+ * limit.
  */
 class SGE_API RenderTarget {
 public:
+    /**
+     * \brief Batch segment fence statistics
+     *
+     *
+     * Counters describing how one segment of the batch ring was used. A stall
+     * is recorded every time the renderer had to wait for the GPU to finish
+     * reading a segment before it could write to it again.
+     */
+    struct FenceStats {
+        std::uint64_t fences;  ///< Fences placed after drawing the segment
+        std::uint64_t stalls;  ///< Times the CPU had to wait for the segment
+        std::uint64_t timeouts;///< Timed out waits while stalled
+    };
+
     /**
      * \brief Create rendering context
      *
@@ -154,19 +176,238 @@ public:
     void drawQuad(const Vertex* vertices,
                   const RenderState& renderState = RenderState::defaultState);
 
+    /**
+     * \brief Draw Quads
+     *
+     *
+     * Draws many quads sharing the same rendering state. The state is checked
+     * once and the vertices are transformed straight into the batch, which is
+     * much cheaper than calling drawQuad for every quad.
+     * \param vertices Pointer to a vertex array with 4 vertices per quad
+     * \param transforms Pointer to an array with a transform per quad, applied
+     * before the state's transform (may be nullptr)
+     * \param count Number of quads
+     * \param renderState Rendering state
+     */
+    void drawQuads(const Vertex* vertices,
+                   const glm::mat4* transforms,
+                   std::size_t count,
+                   const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Draw instanced quads
+     *
+     *
+     * Draws instances of a quad described by a vertex array, bypassing the
+     * batch. The array must have an element buffer with the 6 indices of one
+     * quad. Pending batched draws are flushed first so the call order is
+     * kept. The shader gets the camera transform combined with the state's
+     * transform and the state's texture in unit 0.
+     * \param vao Vertex array with the quad and the instance attributes
+     * \param first Index of the first instance
+     * \param count Number of instances
+     * \param renderState Rendering state (a shader must be set)
+     */
+    void drawInstancedQuads(const VAO& vao,
+                            std::size_t first,
+                            std::size_t count,
+                            const RenderState& renderState);
+
+    /**
+     * \brief Draw a static batch
+     *
+     *
+     * Draws the built geometry of a static batch with indirect multi-draw
+     * calls, without uploading any vertices. Pending batched draws are
+     * flushed first so the call order is kept.
+     * \param batch Static batch
+     * \param renderState Rendering state, only its transform is used
+     */
+    void drawStatic(const StaticBatch& batch,
+                    const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Submit a command list
+     *
+     *
+     * Copies the draws recorded in a command list into the batch. Must be
+     * called from the thread the render target is used on, after the list
+     * was filled.
+     * \param list Command list
+     */
+    void submit(const RenderCommandList& list);
+
+    /**
+     * \brief Submit command lists
+     *
+     *
+     * Copies the draws recorded in several command lists into the batch, in
+     * the order of the lists. Must be called from the thread the render target
+     * is used on, after the lists were filled.
+     * \param lists Pointer to an array of command lists
+     * \param count Number of command lists
+     */
+    void submit(const RenderCommandList* lists, std::size_t count);
+
     /**
      * \brief Flush rendering queue
      * 
      * 
-     * Flushes all pending drawing operations.
+     * Flushes all pending drawing operations. Leaves the context of the target
+     * current.
      */
     void flushRenderQueue();
 
+    /**
+     * \brief Enable or disable deferred mode
+     *
+     *
+     * In deferred mode draws are recorded instead of batched right away. When
+     * the render queue is flushed they are sorted by layer, shader, texture
+     * and depth, so interleaved draws with different states end up in the
+     * same batches. Draws are still emitted in call order inside layers marked
+     * as ordered.
+     * \param deferred Whether to defer draws
+     */
+    void setDeferred(bool deferred);
+
+    /**
+     * \brief Check for deferred mode
+     * \return true if draws are deferred, false otherwise
+     */
+    [[nodiscard]] bool isDeferred() const;
+
+    /**
+     * \brief Keep call order in a layer
+     *
+     *
+     * Sets whether the deferred draws of a layer keep their call order, as
+     * needed for translucent geometry. Layers are not ordered by default.
+     * \param layer Layer
+     * \param ordered Whether to keep call order
+     */
+    void setLayerOrdered(unsigned char layer, bool ordered);
+
+    /**
+     * \brief Check if a layer keeps call order
+     * \param layer Layer
+     * \return true if the layer keeps call order, false otherwise
+     */
+    [[nodiscard]] bool isLayerOrdered(unsigned char layer) const;
+
+    /**
+     * \brief Enable or disable culling
+     *
+     *
+     * With culling enabled, triangles and quads lying entirely outside the
+     * view volume of the camera are dropped before they reach the batch.
+     * This covers the draw calls and submitted command lists, but not
+     * instanced quads and static batches, which are drawn as a whole.
+     * Disabled by default, as it costs an extra transform per vertex.
+     * \param culling Whether to cull draws
+     */
+    void setCulling(bool culling);
+
+    /**
+     * \brief Check for culling
+     * \return true if culling is enabled, false otherwise
+     */
+    [[nodiscard]] bool isCulling() const;
+
+    /**
+     * \brief Get culled count
+     *
+     *
+     * Returns the number of triangles and quads dropped by culling during the
+     * last finished frame.
+     * \return Number of culled primitives in the last frame
+     */
+    [[nodiscard]] unsigned int getCulledCount() const;
+
+    /**
+     * \brief Get number of batch segments
+     *
+     *
+     * Returns the number of fenced segments the batch buffers are split into.
+     * Segments are used round-robin, so the CPU has to wait for the GPU only
+     * when it gets a full ring ahead of it.
+     * \return Number of batch segments
+     */
+    [[nodiscard]] unsigned int getBatchSegments() const;
+
+    /**
+     * \brief Get segment fence statistics
+     * \param segment Index of the segment
+     * \return Fence statistics of the segment
+     */
+    [[nodiscard]] FenceStats getFenceStats(unsigned int segment) const;
+
+    /**
+     * \brief Reset the fence statistics of all segments
+     */
+    void resetFenceStats();
+
+    /**
+     * \brief Check for bindless texture support
+     * \return true if batches can use bindless texture handles, false otherwise
+     */
+    [[nodiscard]] bool hasBindlessTextures() const;
+
+    /**
+     * \brief Get batch capacity
+     *
+     *
+     * Returns the number of vertices that fit in one batch segment. With
+     * adaptive batching enabled this grows when frames keep overflowing the
+     * batch.
+     * \return Number of vertices in a batch segment
+     */
+    [[nodiscard]] std::size_t getBatchCapacity() const;
+
+    /**
+     * \brief Get flush count
+     *
+     *
+     * Returns the number of times the batch was flushed to the GPU during the
+     * last finished frame. Each flush is one draw call.
+     * \return Number of flushes in the last frame
+     */
+    [[nodiscard]] unsigned int getFlushCount() const;
+
     static const CameraOrtho
         defaultCamera;///< Default camera for render targets
 
+protected:
+    /**
+     * \brief End the current frame
+     *
+     *
+     * Records the frame's flush and cull counts and, with adaptive batching
+     * enabled, grows the batch buffers if the last frames kept overflowing
+     * them.
+     * Should be called by render targets after presenting a frame.
+     */
+    void endFrame();
+
 private:
     void setBuffers();
+    void setQuadIndices();
+    void flushBatch();
+    unsigned int prepareBatch(Shader* shader, Texture* texture);
+    Vertex* pushCommand(Shader* shader, Texture* texture, unsigned char layer);
+    void submitCommands();
+    void setWhiteTexture();
+    void setHandleBuffer();
+    bool isCulled(const Vertex* vertices,
+                  std::size_t count,
+                  const RenderState& renderState);
+    void bindTextures(Shader* shader,
+                      Texture* const* textures,
+                      unsigned int count,
+                      bool bindless);
+    void fenceSegment();
+    void waitForSegment();
+    void growBatch();
 
     const Camera* m_camera;
     Context m_context;
@@ -174,13 +415,30 @@ private:
     VBO m_defaultVBO;
     VBO m_defaultEBO;
     std::size_t m_vertexCount;
-    std::size_t m_indicesCount;
-    unsigned int* m_indices;
-    Vertex* m_verticesBatch;
+    BatchVertex* m_verticesBatch;
     Shader* m_currentShader;
-    void* m_sync;
+    std::size_t m_batchCapacity;
+    bool m_adaptiveBatching;
+    bool m_overflowed;
+    unsigned int m_overflowFrames;
+    unsigned int m_flushCount;
+    unsigned int m_lastFlushCount;
+    bool m_culling;
+    unsigned int m_culledCount;
+    unsigned int m_lastCulledCount;
+    unsigned int m_segmentCount;
+    unsigned int m_segment;
+    void* m_segments;
     void* m_usedTextures;
     unsigned int m_usedTextureUnits;
+    unsigned int m_whiteTexture;
+    std::uint64_t m_whiteHandle;
+    bool m_bindless;
+    bool m_batchBindless;
+    VBO m_handleBuffer;
+    std::uint64_t* m_handles;
+    bool m_deferred;
+    void* m_deferredQueue;
 };
 }
 
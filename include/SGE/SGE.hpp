@@ -19,6 +19,7 @@
 #include <SGE/Hash.hpp>
 #include <SGE/Log.hpp>
 #include <SGE/Application.hpp>
+#include <SGE/JobSystem.hpp>
 #include <SGE/Monitor.hpp>
 #include <SGE/Keyboard.hpp>
 #include <SGE/EventHandler.hpp>
@@ -30,19 +31,29 @@
 #include <SGE/Resource.hpp>
 #include <SGE/VBO.hpp>
 #include <SGE/Vertex.hpp>
+#include <SGE/VertexFormat.hpp>
 #include <SGE/VAO.hpp>
 #include <SGE/Shader.hpp>
 #include <SGE/RenderState.hpp>
 #include <SGE/Color.hpp>
 #include <SGE/Drawable.hpp>
+#include <SGE/RenderCommandList.hpp>
 #include <SGE/RenderTarget.hpp>
 #include <SGE/RenderWindow.hpp>
 #include <SGE/Image.hpp>
+#include <SGE/ImageLoader.hpp>
 #include <SGE/Transformable.hpp>
 #include <SGE/Camera.hpp>
 #include <SGE/CameraOrtho.hpp>
 #include <SGE/CameraPersp.hpp>
 #include <SGE/Texture.hpp>
+#include <SGE/TextureAtlas.hpp>
+#include <SGE/MipChain.hpp>
+#include <SGE/VirtualTexture.hpp>
 #include <SGE/Sprite.hpp>
+#include <SGE/SpriteBatch.hpp>
+#include <SGE/StaticBatch.hpp>
+#include <SGE/SceneIndex.hpp>
+#include <SGE/TransformPool.hpp>
 
 #endif//SGE_SGE_HPP
@@ -0,0 +1,202 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_SCENEINDEX_HPP
+#define SGE_SCENEINDEX_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <SGE/Drawable.hpp>
+#include <SGE/Rectangle.hpp>
+
+namespace sge {
+class Transformable;
+class Sprite;
+
+/**
+ * \brief Scene index
+ *
+ *
+ * Spatial index of drawables, used to find the visible ones without testing
+ * every object. Entries are stored with their world bounds in a hashed grid
+ * of square cells, so a query only looks at the cells it overlaps. Entries
+ * can either have fixed world bounds, or track a transformable, in which case
+ * their bounds are given in model space and the entry is moved to other cells
+ * after it is marked as moved. Drawing the index draws the entries visible
+ * to the camera of the render target, in insertion order.
+ * Usage example:
+ * \code
+ * sge::SceneIndex scene;
+ * for (const auto& sprite : sprites) {
+ *     scene.insert(sprite);
+ * }
+ * const auto playerHandle = scene.insert(player);
+ * //In the rendering loop
+ * player.move(1.0f, 0.0f);
+ * scene.markMoved(playerHandle);
+ * renderTarget.draw(scene);
+ * \endcode
+ * \note The indexed objects must outlive their entries.
+ */
+class SGE_API SceneIndex : public Drawable {
+public:
+    using Handle = std::uint32_t;///< Handle of an entry
+
+    /**
+     * \brief Create scene index
+     * \param cellSize Size of the grid cells in world units, which should be
+     * a few times the size of a typical object
+     */
+    explicit SceneIndex(float cellSize = 256.0f);
+
+    /**
+     * \brief Destroy scene index
+     */
+    ~SceneIndex() override;
+
+    SceneIndex(const SceneIndex&) = delete;
+    SceneIndex& operator=(const SceneIndex&) = delete;
+
+    /**
+     * \brief Insert drawable
+     *
+     *
+     * Inserts a drawable which doesn't move. Like every rectangle given to
+     * the index, the bounds have their left and top at the smallest x and y.
+     * Sprite bounds have their top at the largest y instead, so sprites are
+     * inserted with the sprite overload, which converts them.
+     * \param drawable Drawable to insert
+     * \param bounds World bounds of the drawable
+     * \return Handle of the entry
+     */
+    Handle insert(const Drawable& drawable, const RectangleFloat& bounds);
+
+    /**
+     * \brief Insert transformable drawable
+     *
+     *
+     * Inserts a drawable whose world bounds follow a transformable.
+     * \param drawable Drawable to insert
+     * \param transformable Transformable positioning the drawable
+     * \param modelBounds Bounds of the drawable before it is transformed,
+     * with their left and top at the smallest x and y
+     * \return Handle of the entry
+     */
+    Handle insert(const Drawable& drawable,
+                  const Transformable& transformable,
+                  const RectangleFloat& modelBounds);
+
+    /**
+     * \brief Insert sprite
+     *
+     *
+     * Inserts a sprite. A tracked sprite follows the transform it is drawn
+     * with, which is its pooled transform if it has one, and its current
+     * model size is used as its model bounds. Otherwise its current world
+     * bounds are used as fixed bounds.
+     * \param sprite Sprite to insert
+     * \param tracked Whether the entry follows the sprite's transform
+     * \return Handle of the entry
+     */
+    Handle insert(const Sprite& sprite, bool tracked = true);
+
+    /**
+     * \brief Set entry bounds
+     *
+     *
+     * Sets the bounds of an entry. They are in model space if the entry
+     * tracks a transformable, and in world space otherwise. Does nothing if
+     * the entry was removed.
+     * \param handle Handle of the entry
+     * \param bounds New bounds, with their left and top at the smallest x and
+     * y
+     */
+    void setBounds(Handle handle, const RectangleFloat& bounds);
+
+    /**
+     * \brief Mark entry as moved
+     *
+     *
+     * Reports that the transformable of an entry changed, so the next update
+     * moves the entry to the cells of its new bounds. Does nothing if the
+     * entry has fixed bounds or was removed.
+     * \param handle Handle of the entry
+     */
+    void markMoved(Handle handle);
+
+    /**
+     * \brief Remove entry
+     * \param handle Handle of the entry
+     */
+    void remove(Handle handle);
+
+    /**
+     * \brief Remove all entries
+     */
+    void clear();
+
+    /**
+     * \brief Update moved entries
+     *
+     *
+     * Moves the entries marked with markMoved since the last update to the
+     * cells of their new bounds. Called automatically when the index is
+     * drawn. Its cost is linear in the number of marked entries, entries
+     * which didn't move cost nothing.
+     */
+    void update();
+
+    /**
+     * \brief Query visible entries
+     *
+     *
+     * Finds the entries whose bounds intersect an area. The drawables found
+     * are available through getQueryResults until the next query, in
+     * insertion order.
+     * \param area World area to query, with its left and top at the smallest
+     * x and y
+     * \return Number of entries found
+     */
+    std::size_t query(const RectangleFloat& area);
+
+    /**
+     * \brief Get query results
+     * \return Pointer to the drawables found by the last query
+     */
+    [[nodiscard]] const Drawable* const* getQueryResults() const;
+
+    /**
+     * \brief Get entry count
+     * \return Number of entries in the index
+     */
+    [[nodiscard]] std::size_t getSize() const;
+
+protected:
+    /**
+     * \brief Draw visible entries
+     *
+     *
+     * Updates moved entries and draws the entries intersecting the area seen
+     * by the camera of the render target at z = 0.
+     * \param target Render target to draw to
+     * \param renderState Rendering state given by the render target
+     */
+    void draw(RenderTarget& target, RenderState renderState) const override;
+
+private:
+    void* m_data;
+};
+}
+
+#endif//SGE_SCENEINDEX_HPP
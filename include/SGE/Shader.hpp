@@ -45,6 +45,18 @@ public:
         Fragment///< Fragment Shader
     };
 
+    /**
+     * \brief Uniform handle
+     *
+     *
+     * Cached location of a uniform, used to set it without looking it up by
+     * name. A handle to a uniform that doesn't exist has a location of -1,
+     * setting it does nothing.
+     */
+    struct UniformHandle {
+        int location;///< Uniform location
+    };
+
     /**
      * \brief Construct shader
      *
@@ -134,6 +146,16 @@ public:
      */
     [[nodiscard]] bool hasUniform(const char* name);
 
+    /**
+     * \brief Shader has storage block
+     *
+     *
+     * Returns whether the shader declares a shader storage block.
+     * \param name Storage block name
+     * \return true if shader contains the block, false otherwise
+     */
+    [[nodiscard]] bool hasStorageBlock(const char* name) const;
+
     /**
      * \brief Set shader uniform
      *
@@ -164,9 +186,68 @@ public:
      */
     void setUniform(const char* name, signed int sint);
 
+    /**
+     * \brief Get uniform handle
+     *
+     *
+     * Looks up a uniform once, so it can be set later without going through
+     * its name. Handles stay valid until the shader is linked again.
+     * \param name Name of the uniform
+     * \return Handle to the uniform
+     */
+    [[nodiscard]] UniformHandle getUniformHandle(const char* name) const;
+
+    /**
+     * \brief Set shader uniform
+     *
+     *
+     * Sets a matrix shader uniform.
+     * \param handle Handle of the uniform
+     * \param mat Matrix to assign
+     */
+    void setUniform(UniformHandle handle, const glm::mat4& mat);
+
+    /**
+     * \brief Set shader uniform
+     *
+     *
+     * Sets an unsigned int shader uniform.
+     * \param handle Handle of the uniform
+     * \param uint Value to assign
+     */
+    void setUniform(UniformHandle handle, unsigned int uint);
+
+    /**
+     * \brief Set shader uniform
+     *
+     *
+     * Sets a signed int shader uniform.
+     * \param handle Handle of the uniform
+     * \param sint Value to assign
+     */
+    void setUniform(UniformHandle handle, signed int sint);
+
+    /**
+     * \brief Set shader uniform array
+     *
+     *
+     * Sets consecutive elements of a signed int uniform array.
+     * \param handle Handle of the first element to set
+     * \param values Pointer to the values to assign
+     * \param count Number of elements to set
+     */
+    void setUniformArray(UniformHandle handle,
+                         const int* values,
+                         std::size_t count);
+
 private:
     unsigned int m_id;
     void* m_uniforms;
+    UniformHandle m_transform;
+    UniformHandle m_textures;
+    bool m_textureHandles;
+
+    friend class RenderTarget;
 };
 }
 
@@ -21,6 +21,7 @@
 #include <SGE/Transformable.hpp>
 #include <SGE/Vertex.hpp>
 #include <SGE/Rectangle.hpp>
+#include <SGE/TransformPool.hpp>
 #include <glm/vec2.hpp>
 
 namespace sge {
@@ -93,6 +94,20 @@ public:
      */
     void setModelSize(const glm::vec2& size);
 
+    /**
+     * \brief Use a pooled transform
+     *
+     *
+     * Makes the sprite use a transform of a transform pool instead of its own,
+     * so many sprites can be moved with the pool's batched update. The pool
+     * must outlive the sprite or be unset first.
+     * \param pool Pointer to the transform pool (nullptr to use the sprite's
+     * own transform)
+     * \param handle Handle of the transform in the pool
+     */
+    void setPooledTransform(const TransformPool* pool,
+                            TransformPool::Handle handle = 0);
+
     /**
      * \brief Get sprite texture
      * \return Pointer to the texture used by the sprite
@@ -113,16 +128,45 @@ public:
 
     /**
      * \brief Get the bounds of the sprite model
+     *
+     *
+     * The sprite extends down from its origin, so the top of the rectangle
+     * is its largest y.
      * \return Rectangle describing the sprite bounds in model space
      */
     [[nodiscard]] RectangleFloat getModelBounds() const;
 
     /**
      * \brief Get the bounds of the sprite
+     *
+     *
+     * Returns the bounds of the sprite in world space. As for getModelBounds,
+     * the top of the rectangle is its largest y. They are cached and
+     * recomputed only after the sprite is transformed or resized.
      * \return Rectangle describing the sprite bounds in world space
      */
     [[nodiscard]] RectangleFloat getWorldBounds() const;
 
+    /**
+     * \brief Get the world transform
+     *
+     *
+     * Returns the transform the sprite is drawn with, which is the pooled
+     * transform if one is set and the sprite's own transform otherwise.
+     * \return World transform of the sprite
+     */
+    [[nodiscard]] const glm::mat4& getWorldTransform() const;
+
+    /**
+     * \brief Get the world transform revision
+     *
+     *
+     * Returns the revision of the transform returned by getWorldTransform,
+     * which changes whenever that transform changes.
+     * \return World transform revision
+     */
+    [[nodiscard]] std::uint32_t getWorldRevision() const;
+
 protected:
     void draw(RenderTarget& target, RenderState renderState) const override;
 
@@ -130,6 +174,11 @@ private:
     Texture* m_tex;
     Vertex m_vertices[4];
     RectangleFloat m_textureRect;
+    mutable RectangleFloat m_worldBounds;
+    mutable std::uint32_t m_boundsRevision;
+    mutable bool m_boundsNeedUpdate;
+    const TransformPool* m_pool;
+    TransformPool::Handle m_poolHandle;
 };
 }
 
@@ -0,0 +1,195 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_SPRITEBATCH_HPP
+#define SGE_SPRITEBATCH_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <SGE/Drawable.hpp>
+#include <SGE/Transformable.hpp>
+#include <SGE/Color.hpp>
+#include <SGE/Rectangle.hpp>
+#include <SGE/VAO.hpp>
+#include <SGE/VBO.hpp>
+#include <glm/vec2.hpp>
+
+namespace sge {
+class Texture;
+
+/**
+ * \brief Sprite instance
+ *
+ *
+ * Per-instance data of a sprite drawn by a sprite batch. Like a sprite, the
+ * quad has its top left corner at the position and extends right and down by
+ * its size. The texture rectangle is normalized to 0-65535, where 65535
+ * represents 1.0f.
+ */
+struct SGE_API SpriteInstance {
+    glm::vec2 position;          ///< Position of the top left corner
+    glm::vec2 size;              ///< Size of the quad
+    float rotation;              ///< Rotation around the position in degrees
+    Color tint;                  ///< Tint
+    std::uint16_t textureRect[4];///< Texture left, top, width and height
+};
+
+/**
+ * \brief Sprite batch
+ *
+ *
+ * Draws many sprites sharing a texture with a single instanced draw call.
+ * Instead of 4 transformed vertices per sprite, only a 32 byte instance is
+ * uploaded and the quad is built by the vertex shader. The batch is drawn
+ * with the shader of the render state, which receives the instance data in
+ * these attributes:
+ * \code
+ * layout (location = 0) in vec2 corner;      // Unit quad corner (0 or 1)
+ * layout (location = 1) in vec2 position;
+ * layout (location = 2) in vec2 size;
+ * layout (location = 3) in float rotation;   // Degrees
+ * layout (location = 4) in vec4 tint;
+ * layout (location = 5) in vec4 textureRect; // Left, top, width, height
+ *
+ * uniform mat4 transform;
+ *
+ * void main() {
+ *     float angle = radians(rotation);
+ *     vec2 local  = vec2(corner.x, -corner.y) * size;
+ *     vec2 world  = position + mat2(cos(angle), sin(angle),
+ *                                   -sin(angle), cos(angle)) * local;
+ *     gl_Position = transform * vec4(world, 0.0, 1.0);
+ *     // Texture coordinates: textureRect.xy + corner * textureRect.zw
+ * }
+ * \endcode
+ * The texture is bound to unit 0 and set to the tex[0] sampler if the shader
+ * has one. The instance buffer is split into fenced segments which are used
+ * round-robin, so a batch can be drawn several times a frame.
+ * Usage example:
+ * \code
+ * sge::SpriteBatch particles(&texture, 10000);
+ * particles.add({x, y}, {8.0f, 8.0f}, angle);
+ * //In the rendering loop
+ * renderTarget.draw(particles, sge::RenderState(&shader));
+ * \endcode
+ */
+class SGE_API SpriteBatch : public Drawable, public Transformable {
+public:
+    /**
+     * \brief Create sprite batch
+     *
+     *
+     * Creates a sprite batch and its GPU buffers. Requires a current context.
+     * \param texture Pointer to texture to be used (can be nullptr to have no
+     * texture)
+     * \param capacity Number of instances that can be drawn without waiting
+     * for the GPU, per segment
+     * \param segments Number of fenced segments of the instance buffer
+     */
+    explicit SpriteBatch(Texture* texture      = nullptr,
+                         std::size_t capacity  = 10000,
+                         unsigned int segments = 3);
+
+    /**
+     * \brief Destroy sprite batch
+     */
+    ~SpriteBatch() override;
+
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    /**
+     * \brief Set texture
+     * \param texture Pointer to texture to be used (can be nullptr)
+     */
+    void setTexture(Texture* texture);
+
+    /**
+     * \brief Get texture
+     * \return Pointer to the texture used by the batch
+     */
+    [[nodiscard]] Texture* getTexture() const;
+
+    /**
+     * \brief Add sprite instance
+     * \param instance Instance to add
+     */
+    void add(const SpriteInstance& instance);
+
+    /**
+     * \brief Add sprite instance
+     *
+     *
+     * Adds a sprite instance, converting the texture rectangle to the packed
+     * instance format.
+     * \param position Position of the top left corner
+     * \param size Size of the quad
+     * \param rotation Rotation around the position in degrees
+     * \param textureRect Texture rectangle to use (values from 0.0f to 1.0f)
+     * \param tint Tint
+     */
+    void add(const glm::vec2& position,
+             const glm::vec2& size,
+             float rotation = 0.0f,
+             const RectangleFloat& textureRect =
+                 RectangleFloat(0.0f, 0.0f, 1.0f, 1.0f),
+             const Color& tint = Color());
+
+    /**
+     * \brief Remove all instances
+     */
+    void clear();
+
+    /**
+     * \brief Get instances
+     *
+     *
+     * Returns the instances of the batch, which may be modified in place
+     * until instances are added or removed.
+     * \return Pointer to the first instance
+     */
+    [[nodiscard]] SpriteInstance* getInstances();
+
+    /**
+     * \brief Get instance count
+     * \return Number of instances in the batch
+     */
+    [[nodiscard]] std::size_t getInstanceCount() const;
+
+protected:
+    /**
+     * \brief Draw sprite batch
+     * \param target Render target to draw to
+     * \param renderState Rendering state given by the render target
+     */
+    void draw(RenderTarget& target, RenderState renderState) const override;
+
+private:
+    SGE_PRIVATE void waitForSegment() const;
+
+    Texture* m_texture;
+    std::size_t m_capacity;
+    unsigned int m_segmentCount;
+    mutable unsigned int m_segment;
+    void* m_instances;
+    void* m_fences;
+    VAO m_vao;
+    VBO m_quadVBO;
+    VBO m_quadEBO;
+    mutable VBO m_instanceVBO;
+    SpriteInstance* m_mapped;
+};
+}
+
+#endif//SGE_SPRITEBATCH_HPP
@@ -0,0 +1,148 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_STATICBATCH_HPP
+#define SGE_STATICBATCH_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <SGE/Drawable.hpp>
+#include <SGE/Vertex.hpp>
+#include <SGE/RenderState.hpp>
+
+namespace sge {
+/**
+ * \brief Static batch
+ *
+ *
+ * Holds geometry that doesn't change, such as tile maps and backgrounds.
+ * Quads are added once, transformed by the state they were added with, and
+ * uploaded to immutable GPU buffers when the batch is built. Drawing the batch
+ * doesn't upload anything: consecutive quads sharing a shader are drawn with a
+ * single indirect multi-draw call, using the transform of the render state
+ * the batch is drawn with.
+ * Usage example:
+ * \code
+ * sge::StaticBatch level;
+ * for (const auto& tile : tiles) {
+ *     level.addQuad(tile.vertices, sge::RenderState(tile.texture));
+ * }
+ * level.build();
+ * //In the rendering loop
+ * renderTarget.draw(level);
+ * \endcode
+ * \note The layer of render states is ignored, the batch is drawn in call
+ * order with the other draws.
+ */
+class SGE_API StaticBatch : public Drawable {
+public:
+    /**
+     * \brief Create static batch
+     *
+     *
+     * Creates an empty static batch. Requires a current context.
+     */
+    StaticBatch();
+
+    /**
+     * \brief Destroy static batch
+     */
+    ~StaticBatch() override;
+
+    StaticBatch(const StaticBatch&) = delete;
+    StaticBatch& operator=(const StaticBatch&) = delete;
+
+    /**
+     * \brief Add a triangle
+     * \param vertices Pointer to a vertex array with 3 vertices
+     * \param renderState Rendering state
+     */
+    void
+    addTriangle(const Vertex* vertices,
+                const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Add a quad
+     * \param vertices Pointer to a vertex array with 4 vertices
+     * \param renderState Rendering state
+     */
+    void addQuad(const Vertex* vertices,
+                 const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Add quads
+     * \param vertices Pointer to a vertex array with 4 vertices per quad
+     * \param transforms Pointer to an array with a transform per quad, applied
+     * before the state's transform (may be nullptr)
+     * \param count Number of quads
+     * \param renderState Rendering state
+     */
+    void addQuads(const Vertex* vertices,
+                  const glm::mat4* transforms,
+                  std::size_t count,
+                  const RenderState& renderState = RenderState::defaultState);
+
+    /**
+     * \brief Build the batch
+     *
+     *
+     * Uploads the added geometry to the GPU and records the draw commands.
+     * Geometry added after building is drawn only after the batch is built
+     * again. Requires a current context.
+     */
+    void build();
+
+    /**
+     * \brief Clear the batch
+     *
+     *
+     * Removes all added geometry. The built geometry is kept until the batch
+     * is built again.
+     */
+    void clear();
+
+    /**
+     * \brief Check if the batch is built
+     * \return true if the added geometry was uploaded, false otherwise
+     */
+    [[nodiscard]] bool isBuilt() const;
+
+    /**
+     * \brief Get number of added quads
+     *
+     *
+     * Returns the number of added quads. Triangles are counted as quads.
+     * \return Number of quads
+     */
+    [[nodiscard]] std::size_t getQuadCount() const;
+
+protected:
+    /**
+     * \brief Draw static batch
+     * \param target Render target to draw to
+     * \param renderState Rendering state given by the render target
+     */
+    void draw(RenderTarget& target, RenderState renderState) const override;
+
+private:
+    SGE_PRIVATE Vertex* append(const RenderState& renderState,
+                               std::size_t quads);
+
+    void* m_data;
+
+    friend class RenderTarget;
+};
+}
+
+#endif//SGE_STATICBATCH_HPP
@@ -19,8 +19,11 @@
 #include <SGE/Resource.hpp>
 #include <SGE/Image.hpp>
 #include <glm/vec2.hpp>
+#include <cstdint>
 
 namespace sge {
+class MipChain;
+
 /**
  * \brief Texture object
  *
@@ -28,6 +31,12 @@ namespace sge {
  * Object representing a texture, which is used for rendering objects.
  * The texture does not hold it's image data. It only holds a handle
  * to the OpenGL texture, which most likely will be held in VRAM.
+ * Besides the formats supported by Image, textures can be loaded from DDS
+ * and KTX2 files holding BC1, BC3 or BC7 compressed images. These stay
+ * compressed in VRAM and keep their stored mipmap levels; if the driver
+ * cannot sample BC1 or BC3, they are decompressed while loading.
+ * The mipmap mode decides how many levels are allocated and how they are
+ * filled; it must be set before loading to take effect.
  * Usage example:
  * \code
  * sge::Texture t("/texture.png");
@@ -50,6 +59,19 @@ public:
         ClampToBorder  ///< Clamp to the border of the texture
     };
 
+    /**
+     * \brief Texture mipmap mode
+     *
+     *
+     * Decides how the mipmap levels of a texture are created when it is
+     * loaded or created.
+     */
+    enum class MipmapMode {
+        None,///< Allocate only the base level
+        Gpu, ///< Allocate the full chain and generate it on the GPU at load
+        Cpu  ///< Generate the chain on the CPU with a Kaiser filter
+    };
+
     /**
      * \brief Texture filtering mode
      *
@@ -141,6 +163,86 @@ public:
      */
     bool loadFromImage(const Image& image);
 
+    /**
+     * \brief Load texture
+     *
+     *
+     * Load a texture from a precomputed mip chain, uploading all of its
+     * levels. In MipmapMode::None only the base level is uploaded. Fails when
+     * the chain is larger than getMaximumSize().
+     * \param chain Mip chain to load from
+     * \return true on success, false otherwise
+     */
+    bool loadFromMipChain(const MipChain& chain);
+
+    /**
+     * \brief Load texture asynchronously
+     *
+     *
+     * Queues a virtual file to be decoded and uploaded on a loader thread and
+     * returns immediately. Until isReady returns true the texture is empty.
+     * Must be called on the main thread. Accepts the same files as
+     * loadFromFile, DDS and KTX2 containers included. In MipmapMode::Cpu the
+     * loader thread also generates the mip chain before uploading it. A file
+     * which can't be loaded is logged, and the texture stays empty.
+     * \param path Path to file
+     * \return true if the load was queued, false otherwise
+     */
+    bool loadAsync(const char* path);
+
+    /**
+     * \brief Check if the texture is ready
+     *
+     *
+     * Checks whether the texture holds an image. For an asynchronous load,
+     * the texture takes over the uploaded image once the upload has
+     * finished on the GPU, which is checked without waiting.
+     * \return true if the texture can be used, false otherwise
+     */
+    [[nodiscard]] bool isReady();
+
+    /**
+     * \brief Check if the texture is loading
+     * \return true if an asynchronous load is still pending, false otherwise
+     */
+    [[nodiscard]] bool isLoading() const;
+
+    /**
+     * \brief Create texture
+     *
+     *
+     * Creates an empty texture, with all the pixels transparent black.
+     * \param size Size of the texture
+     * \return true on success, false otherwise
+     */
+    bool create(const glm::uvec2& size);
+
+    /**
+     * \brief Update texture
+     *
+     *
+     * Replaces a part of the texture with RGBA pixels. The area must be
+     * inside the texture. The mipmaps are out of date until generateMipmaps
+     * is called.
+     * \param pixels Pointer to the pixels, 4 bytes each, row by row
+     * \param size Size of the updated area
+     * \param position Top left corner of the updated area
+     */
+    void update(const unsigned char* pixels,
+                const glm::uvec2& size,
+                const glm::uvec2& position);
+
+    /**
+     * \brief Update texture
+     *
+     *
+     * Replaces a part of the texture with the pixels of an image. The image
+     * must fit inside the texture.
+     * \param image Image to copy
+     * \param position Top left corner of the updated area
+     */
+    void update(const Image& image, const glm::uvec2& position);
+
     /**
      * \brief Set texture wrapping mode
      * \param mode Wrapping mode
@@ -153,8 +255,23 @@ public:
      */
     void setFilterMode(FilterMode mode);
 
+    /**
+     * \brief Set texture mipmap mode
+     *
+     *
+     * Sets how mipmaps are created by the next load or create call. The
+     * default is MipmapMode::Gpu.
+     * \param mode Mipmap mode
+     */
+    void setMipmapMode(MipmapMode mode);
+
     /**
      * \brief Generate texture mipmaps
+     *
+     *
+     * Regenerates the mipmap levels from the base level, for example after
+     * updating the texture. Does nothing if the texture has a single level,
+     * or if its mipmaps are still up to date.
      */
     void generateMipmaps();
 
@@ -185,12 +302,31 @@ public:
      */
     FilterMode getFilterMode() const;
 
+    /**
+     * \brief Get texture mipmap mode
+     * \return Texture mipmap mode
+     */
+    [[nodiscard]] MipmapMode getMipmapMode() const;
+
     /**
      * \brief Texture has mipmaps
      * \return true if texture has mipmaps, false otherwise
      */
     bool hasMipmaps() const;
 
+    /**
+     * \brief Get bindless handle
+     *
+     *
+     * Returns a resident bindless handle for the texture, creating it on the
+     * first call. Requires GL_ARB_bindless_texture, returns 0 when it is not
+     * supported. Once a handle was created the wrapping and filtering modes
+     * of the texture can no longer be changed, setWrapMode and setFilterMode
+     * are ignored until the texture is loaded or created again.
+     * \return Texture handle, or 0 if bindless textures are unavailable
+     */
+    [[nodiscard]] std::uint64_t getHandle();
+
     /**
      * \brief Get maximum texture size
      *
@@ -212,11 +348,23 @@ public:
     static unsigned int getMaximumImageUnits();
 
 private:
+    void releaseHandle();
+    void cancelStream();
+    bool loadCompressed(std::size_t size, const void* data);
+    bool storePixels(const unsigned char* pixels);
+    static unsigned int getLevelCount(const glm::uvec2& size);
+
     unsigned int m_id;
     glm::uvec2 m_size;
     WrapMode m_wrapMode;
     FilterMode m_filterMode;
     bool m_hasMipmaps;
+    std::uint64_t m_handle;
+    void* m_stream;
+    MipmapMode m_mipmapMode;
+    unsigned int m_levels;
+
+    friend class RenderTarget;
 };
 }
 
@@ -0,0 +1,146 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_TEXTUREATLAS_HPP
+#define SGE_TEXTUREATLAS_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <SGE/Rectangle.hpp>
+#include <glm/vec2.hpp>
+
+namespace sge {
+class Image;
+class Texture;
+
+/**
+ * \brief Texture atlas
+ *
+ *
+ * Packs many images into a few large textures (pages), so sprites using them
+ * share textures and can be batched together. Images are placed with a
+ * skyline bottom-left packer and can be inserted at any time; a new page is
+ * created when an image fits in none of the existing ones. Each image can be
+ * surrounded by a padding of repeated edge pixels, which keeps filtering from
+ * bleeding neighbouring images into it. Pages have no mipmaps.
+ * Usage example:
+ * \code
+ * sge::TextureAtlas atlas;
+ * sge::TextureAtlas::Region region;
+ * if (atlas.insert(sge::Image("/player.png"), region)) {
+ *     sprite.setTexture(region.texture);
+ *     sprite.setTextureRectangle(region.rectangle);
+ * }
+ * \endcode
+ */
+class SGE_API TextureAtlas {
+public:
+    /**
+     * \brief Atlas region
+     *
+     *
+     * Location of an inserted image inside the atlas.
+     */
+    struct Region {
+        Texture* texture;        ///< Page holding the image
+        RectangleFloat rectangle;///< Texture rectangle (values from 0 to 1)
+        RectangleInt pixels;     ///< Rectangle in page pixels
+    };
+
+    /**
+     * \brief Create texture atlas
+     *
+     *
+     * Creates an empty atlas. Pages are created when needed, which requires a
+     * current context.
+     * \param pageSize Size of the atlas pages, limited to the maximum texture
+     * size
+     * \param padding Number of edge pixels repeated around each image
+     */
+    explicit TextureAtlas(const glm::uvec2& pageSize = glm::uvec2(2048, 2048),
+                          unsigned int padding       = 1);
+
+    /**
+     * \brief Destroy texture atlas
+     *
+     *
+     * Destroys the atlas and its pages.
+     */
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    /**
+     * \brief Insert image
+     *
+     *
+     * Packs an image into the atlas and uploads its pixels.
+     * \param image Image to insert
+     * \param region Region the image was placed in
+     * \return true on success, false if the image is empty or larger than a
+     * page
+     */
+    bool insert(const Image& image, Region& region);
+
+    /**
+     * \brief Insert pixels
+     *
+     *
+     * Packs RGBA pixels into the atlas and uploads them.
+     * \param pixels Pointer to the pixels, 4 bytes each, row by row
+     * \param size Size of the image
+     * \param region Region the image was placed in
+     * \return true on success, false if the image is empty or larger than a
+     * page
+     */
+    bool insert(const unsigned char* pixels,
+                const glm::uvec2& size,
+                Region& region);
+
+    /**
+     * \brief Remove all images
+     *
+     *
+     * Destroys all pages. Regions returned before are no longer valid.
+     */
+    void clear();
+
+    /**
+     * \brief Get page count
+     * \return Number of pages of the atlas
+     */
+    [[nodiscard]] std::size_t getPageCount() const;
+
+    /**
+     * \brief Get page
+     * \param index Index of the page
+     * \return Pointer to the page texture
+     */
+    [[nodiscard]] Texture* getPage(std::size_t index) const;
+
+    /**
+     * \brief Get page size
+     * \return Size of the atlas pages
+     */
+    [[nodiscard]] const glm::uvec2& getPageSize() const;
+
+private:
+    glm::uvec2 m_pageSize;
+    unsigned int m_padding;
+    void* m_pages;
+};
+}
+
+#endif//SGE_TEXTUREATLAS_HPP
@@ -0,0 +1,211 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_TRANSFORMPOOL_HPP
+#define SGE_TRANSFORMPOOL_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace sge {
+class JobSystem;
+
+/**
+ * \brief Transform pool
+ *
+ *
+ * Stores the transforms of many objects as separate arrays of components
+ * (structure of arrays), addressed through handles. Changing a transform only
+ * marks it dirty, and updateAll recomputes the dirty matrices four at a time
+ * over contiguous memory. Transforms are computed the same way as for a
+ * Transformable, with a fast path for objects which only rotate around z.
+ * Usage example:
+ * \code
+ * sge::TransformPool pool;
+ * auto handle = pool.create();
+ * sprite.setPooledTransform(&pool, handle);
+ * //Every frame
+ * pool.move(handle, velocity);
+ * pool.updateAll(sge::Application::getJobSystem());
+ * renderTarget.draw(sprite);
+ * \endcode
+ */
+class SGE_API TransformPool {
+public:
+    using Handle = std::uint32_t;///< Handle of a transform
+
+    /**
+     * \brief Create transform pool
+     *
+     *
+     * Creates an empty transform pool.
+     */
+    TransformPool();
+
+    /**
+     * \brief Destroy transform pool
+     */
+    ~TransformPool();
+
+    TransformPool(const TransformPool&) = delete;
+    TransformPool& operator=(const TransformPool&) = delete;
+
+    /**
+     * \brief Create transform
+     *
+     *
+     * Creates an identity transform with (0, 0) origin and position, 0
+     * rotation and a scale of 1.
+     * \return Handle of the transform
+     */
+    Handle create();
+
+    /**
+     * \brief Destroy transform
+     * \param handle Handle of the transform
+     */
+    void destroy(Handle handle);
+
+    /**
+     * \brief Set origin
+     * \param handle Handle of the transform
+     * \param origin Origin position
+     */
+    void setOrigin(Handle handle, const glm::vec3& origin);
+
+    /**
+     * \brief Set position
+     * \param handle Handle of the transform
+     * \param position Position
+     */
+    void setPosition(Handle handle, const glm::vec3& position);
+
+    /**
+     * \brief Set positions
+     *
+     *
+     * Sets the positions of several transforms at once.
+     * \param handles Pointer to an array of handles
+     * \param positions Pointer to an array with a position per handle
+     * \param count Number of handles
+     */
+    void setPositions(const Handle* handles,
+                      const glm::vec3* positions,
+                      std::size_t count);
+
+    /**
+     * \brief Set scale
+     * \param handle Handle of the transform
+     * \param factor Scale factor
+     */
+    void setScale(Handle handle, const glm::vec3& factor);
+
+    /**
+     * \brief Set rotation
+     * \param handle Handle of the transform
+     * \param degrees Rotation vector in degrees
+     */
+    void setRotation(Handle handle, const glm::vec3& degrees);
+
+    /**
+     * \brief Move transform
+     * \param handle Handle of the transform
+     * \param offset Position offset
+     */
+    void move(Handle handle, const glm::vec3& offset);
+
+    /**
+     * \brief Get origin
+     * \param handle Handle of the transform
+     * \return Origin position
+     */
+    [[nodiscard]] glm::vec3 getOrigin(Handle handle) const;
+
+    /**
+     * \brief Get position
+     * \param handle Handle of the transform
+     * \return Position
+     */
+    [[nodiscard]] glm::vec3 getPosition(Handle handle) const;
+
+    /**
+     * \brief Get scale
+     * \param handle Handle of the transform
+     * \return Scale factor
+     */
+    [[nodiscard]] glm::vec3 getScale(Handle handle) const;
+
+    /**
+     * \brief Get rotation
+     * \param handle Handle of the transform
+     * \return Rotation vector in degrees
+     */
+    [[nodiscard]] glm::vec3 getRotation(Handle handle) const;
+
+    /**
+     * \brief Update all transforms
+     *
+     *
+     * Recomputes the matrices of all transforms changed since they were last
+     * computed.
+     */
+    void updateAll();
+
+    /**
+     * \brief Update all transforms
+     *
+     *
+     * Recomputes the matrices of all transforms changed since they were last
+     * computed, splitting the pool between the threads of the job system.
+     * Returns once every matrix is up to date.
+     * \param jobSystem Job system to run the update on
+     */
+    void updateAll(JobSystem& jobSystem);
+
+    /**
+     * \brief Get transform matrix
+     *
+     *
+     * Returns the matrix of a transform, computing it first if it is dirty.
+     * The reference stays valid until a transform is created or destroyed.
+     * \param handle Handle of the transform
+     * \return Transform matrix
+     */
+    [[nodiscard]] const glm::mat4& getTransform(Handle handle) const;
+
+    /**
+     * \brief Get revision
+     *
+     *
+     * Returns a counter which is incremented every time the transform
+     * changes.
+     * \param handle Handle of the transform
+     * \return Transform revision
+     */
+    [[nodiscard]] std::uint32_t getRevision(Handle handle) const;
+
+    /**
+     * \brief Get transform count
+     * \return Number of transforms in the pool
+     */
+    [[nodiscard]] std::size_t getSize() const;
+
+private:
+    void* m_data;
+};
+}
+
+#endif//SGE_TRANSFORMPOOL_HPP
@@ -16,6 +16,7 @@
 #define SGE_TRANSFORMABLE_HPP
 
 #include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
 
@@ -211,6 +212,17 @@ public:
      */
     [[nodiscard]] const glm::mat4& getTransform() const;
 
+    /**
+     * \brief Get revision
+     *
+     *
+     * Returns a counter which is incremented every time the object's transform
+     * changes. Comparing it to a previously read value tells whether the
+     * object was moved, rotated or scaled since.
+     * \return Transform revision
+     */
+    [[nodiscard]] std::uint32_t getRevision() const;
+
 private:
     glm::vec3 m_origin;
     glm::vec3 m_position;
@@ -218,6 +230,7 @@ private:
     glm::vec3 m_rotation;
     mutable glm::mat4 m_transform;
     mutable bool m_transformNeedsUpdate;
+    std::uint32_t m_revision;
 };
 }
 
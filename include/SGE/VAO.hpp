@@ -123,6 +123,28 @@ public:
     void setAttributeBinding(unsigned int index,
                              unsigned int bindingIndex) const;
 
+    /**
+     * \brief Set binding divisor
+     *
+     *
+     * Sets how often the attributes of a VBO binding advance. A divisor of 0
+     * advances them every vertex, any other value advances them every
+     * divisor instances.
+     * \param bindingIndex VBO binding index
+     * \param divisor Number of instances per element
+     */
+    void setBindingDivisor(unsigned int bindingIndex,
+                           unsigned int divisor) const;
+
+    /**
+     * \brief Set element buffer
+     *
+     *
+     * Attaches an index buffer to this array object.
+     * \param ebo Buffer holding the indices
+     */
+    void setElementBuffer(const VBO& ebo) const;
+
     /**
      * \brief Bind this VAO
      */
@@ -45,6 +45,17 @@ public:
         WriteAccess = 1 << 1 ///< Buffer may be accessed for writing
     };
 
+    /**
+     * \brief Buffer range
+     *
+     *
+     * Sub-region of a buffer, in bytes.
+     */
+    struct Range {
+        std::size_t offset;///< Offset of the region
+        std::size_t length;///< Length of the region
+    };
+
     /**
      * \brief Create vertex buffer
      *
@@ -152,6 +163,18 @@ public:
      */
     void flushChanges(std::size_t offset, std::size_t length);
 
+    /**
+     * \brief Flush changes
+     *
+     *
+     * Flushes the changes made to several sub-regions of a buffer mapping.
+     * The ranges don't need to be sorted, overlapping and adjacent ranges are
+     * merged so each contiguous region is flushed only once.
+     * \param ranges Pointer to an array of ranges
+     * \param count Number of ranges in the array
+     */
+    void flushRanges(const Range* ranges, std::size_t count);
+
     /**
      * \brief Bind as element array
      *
@@ -160,6 +183,36 @@ public:
      */
     void bindElementArray();
 
+    /**
+     * \brief Bind as shader storage
+     *
+     *
+     * Binds a range of the buffer to an indexed shader storage binding point.
+     * \param index Binding point index
+     * \param offset Offset of the range
+     * \param length Length of the range
+     */
+    void bindShaderStorage(unsigned int index,
+                           std::size_t offset,
+                           std::size_t length);
+
+    /**
+     * \brief Bind as draw indirect buffer
+     *
+     *
+     * Binds the buffer as the source of indirect draw commands.
+     */
+    void bindDrawIndirect();
+
+    /**
+     * \brief Bind as pixel unpack buffer
+     *
+     *
+     * Binds the buffer as the source of texture uploads, which then take
+     * offsets into the buffer instead of pointers to client memory.
+     */
+    void bindPixelUnpack();
+
 private:
     unsigned int m_id;
     bool m_allocated;
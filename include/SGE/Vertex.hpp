@@ -19,6 +19,7 @@
 #include <SGE/Types.hpp>
 #include <SGE/Color.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 
 namespace sge {
 /**
@@ -33,6 +34,29 @@ struct SGE_API Vertex {
     glm::vec2 texPos;///< Texture position
     float texUnit;   ///< Texture unit (set by the batch renderer)
 };
+
+/**
+ * \brief Packed vertex object
+ *
+ *
+ * Compact vertex layout used by the batch renderer when the engine is built
+ * with SGE_PACKED_VERTICES. Texture coordinates are stored as half floats and
+ * the texture unit as a 16-bit integer, which makes it 24 bytes instead of
+ * the 28 bytes of a Vertex. Shaders see the same attributes in both layouts.
+ */
+struct SGE_API PackedVertex {
+    glm::vec3 pos;          ///< Position
+    Color tint;             ///< Tint
+    std::uint16_t texPos[2];///< Texture position (half floats)
+    std::uint16_t texUnit;  ///< Texture unit (set by the batch renderer)
+    std::uint16_t padding;  ///< Padding to keep the size a multiple of 4
+};
+
+#ifdef SGE_PACKED_VERTICES
+using BatchVertex = PackedVertex;///< Vertex layout used for batching
+#else
+using BatchVertex = Vertex;///< Vertex layout used for batching
+#endif
 }
 
 #endif//SGE_VERTEX_HPP
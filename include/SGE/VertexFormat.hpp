@@ -0,0 +1,72 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_VERTEXFORMAT_HPP
+#define SGE_VERTEXFORMAT_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Types.hpp>
+#include <SGE/Vertex.hpp>
+#include <SGE/VAO.hpp>
+
+namespace sge {
+/**
+ * \brief Vertex format trait
+ *
+ *
+ * Describes how a vertex type is laid out for the GPU. Specializations
+ * configure a VAO so that every layout exposes the same attributes to
+ * shaders: position (location 0, vec3), tint (location 1, vec4), texture
+ * position (location 2, vec2) and texture unit (location 3, float).
+ * \tparam T Vertex type
+ */
+template<typename T>
+struct VertexFormat;
+
+/**
+ * \brief Vertex format of Vertex
+ */
+template<>
+struct SGE_API VertexFormat<Vertex> {
+    /**
+     * \brief Configure vertex array
+     *
+     *
+     * Sets up the attributes 0 to 3 of a vertex array to read vertices from
+     * a VBO binding.
+     * \param vao Vertex array to configure
+     * \param bindingIndex VBO binding index holding the vertices
+     */
+    static void configure(const VAO& vao, unsigned int bindingIndex);
+};
+
+/**
+ * \brief Vertex format of PackedVertex
+ */
+template<>
+struct SGE_API VertexFormat<PackedVertex> {
+    /**
+     * \brief Configure vertex array
+     *
+     *
+     * Sets up the attributes 0 to 3 of a vertex array to read packed vertices
+     * from a VBO binding.
+     * \param vao Vertex array to configure
+     * \param bindingIndex VBO binding index holding the vertices
+     */
+    static void configure(const VAO& vao, unsigned int bindingIndex);
+};
+}
+
+#endif//SGE_VERTEXFORMAT_HPP
@@ -0,0 +1,181 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_VIRTUALTEXTURE_HPP
+#define SGE_VIRTUALTEXTURE_HPP
+
+#include <SGE/Export.hpp>
+#include <SGE/Drawable.hpp>
+#include <SGE/Transformable.hpp>
+#include <SGE/SpriteBatch.hpp>
+#include <SGE/Texture.hpp>
+#include <glm/vec2.hpp>
+
+namespace sge {
+class RenderTarget;
+
+/**
+ * \brief Virtual texture
+ *
+ *
+ * Draws an image larger than the maximum texture size, such as a world map,
+ * by keeping only the tiles the camera can see in a fixed size tile cache
+ * texture. The image is split into square tiles stored as separate files,
+ * with a level of coarser tiles for each halving of the resolution:
+ * \code
+ * <directory>/<level>/<x>_<y>.png
+ * \endcode
+ * Level 0 has the full resolution, and a tile of level n covers 2^n by 2^n
+ * tiles of level 0. Tiles on the right and bottom edges may be smaller than
+ * the tile size. The last level holds a single tile covering the whole
+ * image, which always stays in the cache.
+ *
+ * Each update picks the level matching the on-screen scale, loads the
+ * missing visible tiles on the job system and evicts the least recently
+ * used tiles once the cache is full, so the memory used does not depend on
+ * the image size apart from the indirection table, which takes 4 bytes per
+ * level 0 tile. Until a tile arrives, the finest resident tile covering it
+ * is drawn instead.
+ *
+ * The virtual texture is drawn as a sprite batch quad covering the image, so
+ * the shader receives the attributes described by SpriteBatch. The tile
+ * cache is bound to unit 0, and the indirection table to unit 1; each of its
+ * texels holds the cache slot (x, y) and the level (z) of the tile drawn for
+ * a level 0 tile, with w set to 0 where nothing is resident yet. The
+ * fragment shader samples it like this:
+ * \code
+ * uniform sampler2D tex[1];
+ * layout (binding = 1) uniform sampler2D indirection;
+ * uniform int virtualTileSize;
+ * uniform int virtualWidth;
+ * uniform int virtualHeight;
+ *
+ * vec4 sampleVirtual(vec2 texCoord) {
+ *     vec2 tile  = texCoord * vec2(virtualWidth, virtualHeight) /
+ *                  float(virtualTileSize);
+ *     ivec2 last = textureSize(indirection, 0) - 1;
+ *     vec4 entry = texelFetch(indirection, min(ivec2(tile), last), 0) * 255.0;
+ *     if (entry.w == 0.0) {
+ *         return vec4(0.0);
+ *     }
+ *
+ *     // Cache slots have a border of 1 pixel around the tile
+ *     vec2 inTile = fract(tile / exp2(entry.z)) * float(virtualTileSize);
+ *     vec2 texel  = entry.xy * float(virtualTileSize + 2) + 1.0 + inTile;
+ *     return texture(tex[0], texel / vec2(textureSize(tex[0], 0)));
+ * }
+ * \endcode
+ * Usage example:
+ * \code
+ * sge::Filesystem::mount("world.zip", "/world");
+ * sge::VirtualTexture world("/world/map", {65536, 32768});
+ * //In the rendering loop
+ * world.update(renderTarget);
+ * renderTarget.draw(world, sge::RenderState(&virtualShader));
+ * \endcode
+ */
+class SGE_API VirtualTexture : public Drawable, public Transformable {
+public:
+    /**
+     * \brief Create virtual texture
+     *
+     *
+     * Creates the tile cache and the indirection table. Requires a current
+     * context. No tiles are loaded until the first update.
+     * \param directory Virtual directory holding the tile levels
+     * \param size Size of the whole image in pixels
+     * \param tileSize Size of the tiles in pixels
+     * \param cacheTiles Number of tiles along each side of the tile cache,
+     * limited by the maximum texture size
+     */
+    VirtualTexture(const char* directory,
+                   const glm::uvec2& size,
+                   unsigned int tileSize   = 256,
+                   unsigned int cacheTiles = 16);
+
+    /**
+     * \brief Destroy virtual texture
+     *
+     *
+     * Waits for the tile loads in flight and destroys the textures.
+     */
+    ~VirtualTexture() override;
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    /**
+     * \brief Update resident tiles
+     *
+     *
+     * Uploads the tiles loaded since the last update and queues loads for the
+     * tiles visible through the camera of the render target, nearest to the
+     * center of the view first. Without worker threads in the job system the
+     * tiles are loaded before returning. Must be called on the main thread.
+     * \param target Render target the virtual texture is drawn to
+     */
+    void update(const RenderTarget& target);
+
+    /**
+     * \brief Get size
+     * \return Size of the whole image in pixels
+     */
+    [[nodiscard]] const glm::uvec2& getSize() const;
+
+    /**
+     * \brief Get tile size
+     * \return Size of the tiles in pixels
+     */
+    [[nodiscard]] unsigned int getTileSize() const;
+
+    /**
+     * \brief Get level count
+     * \return Number of tile levels, including the full resolution one
+     */
+    [[nodiscard]] unsigned int getLevelCount() const;
+
+    /**
+     * \brief Get resident tile count
+     * \return Number of tiles currently held by the tile cache
+     */
+    [[nodiscard]] std::size_t getResidentTileCount() const;
+
+protected:
+    /**
+     * \brief Draw virtual texture
+     *
+     *
+     * Requires a shader in the render state. Uniform locations are cached
+     * for the last shader used, so a shader shouldn't be linked again while
+     * it draws virtual textures.
+     * \param target Render target to draw to
+     * \param renderState Rendering state given by the render target
+     */
+    void draw(RenderTarget& target, RenderState renderState) const override;
+
+private:
+    SGE_PRIVATE void finishLoads();
+    SGE_PRIVATE bool startLoad(std::uint64_t key);
+    SGE_PRIVATE void uploadTable();
+
+    glm::uvec2 m_size;
+    unsigned int m_tileSize;
+    Texture m_cache;
+    mutable Texture m_table;
+    SpriteBatch m_batch;
+    void* m_data;
+};
+}
+
+#endif//SGE_VIRTUALTEXTURE_HPP
@@ -15,7 +15,9 @@
 #include <SGE/Application.hpp>
 #include <SGE/Version.hpp>
 #include <SGE/Context.hpp>
+#include <SGE/JobSystem.hpp>
 #include <SGE/Log.hpp>
+#include "TextureStreamer.hpp"
 #include <cassert>
 #include <exception>
 #include <string>
@@ -29,7 +31,8 @@ sge::Application* current = nullptr;
 }
 
 namespace sge {
-Application::Application() : m_args(nullptr), m_argc(0) {
+Application::Application()
+    : m_args(nullptr), m_argc(0), m_jobSystem(nullptr) {
     if (current != nullptr) {
         crashApplication("More than one active progra");
     }
@@ -71,11 +74,19 @@ Application::Application() : m_args(nullptr), m_argc(0) {
                  << reinterpret_cast<const char*>(glGetString(GL_VERSION))
                  << Log::Operation::Endl;
 
+    try {
+        m_jobSystem = new JobSystem;
+    } catch (...) {
+        crashApplication("Bad alloc");
+    }
+    Log::general << Log::MessageType::Info << "Job system workers: "
+                 << m_jobSystem->getWorkerCount() << Log::Operation::Endl;
+
     current = this;
 }
 
 Application::Application(const int argc, char** argv)
-    : m_args(nullptr), m_argc(0) {
+    : m_args(nullptr), m_argc(0), m_jobSystem(nullptr) {
     if (current != nullptr) {
         crashApplication("More than one application is current");
     }
@@ -121,12 +132,22 @@ Application::Application(const int argc, char** argv)
                  << reinterpret_cast<const char*>(glGetString(GL_VERSION))
                  << Log::Operation::Endl;
 
+    try {
+        m_jobSystem = new JobSystem;
+    } catch (...) {
+        crashApplication("Bad alloc");
+    }
+    Log::general << Log::MessageType::Info << "Job system workers: "
+                 << m_jobSystem->getWorkerCount() << Log::Operation::Endl;
+
     current = this;
 }
 
 Application::~Application() {
     assert(current == this);
 
+    TextureStreamer::shutdown();
+    delete m_jobSystem;
     Log::general.close();
 
     PHYSFS_deinit();
@@ -160,6 +181,12 @@ int Application::getArgCount() const {
     return m_argc;
 }
 
+JobSystem& Application::getJobSystem() {
+    assert(current != nullptr);
+
+    return *current->m_jobSystem;
+}
+
 void Application::crashApplication(const char* reason) {
     try {
         std::string message =
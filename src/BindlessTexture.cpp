@@ -0,0 +1,72 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BindlessTexture.hpp"
+#include <SGE/Context.hpp>
+#include <cassert>
+#include <mutex>
+#include <SDL.h>
+#include <glad.h>
+
+namespace {
+using GetTextureHandle      = GLuint64(APIENTRYP)(GLuint);
+using MakeHandleResident    = void(APIENTRYP)(GLuint64);
+using MakeHandleNonResident = void(APIENTRYP)(GLuint64);
+
+GetTextureHandle getTextureHandle           = nullptr;
+MakeHandleResident makeHandleResident       = nullptr;
+MakeHandleNonResident makeHandleNonResident = nullptr;
+bool available                              = false;
+std::once_flag loadFlag;
+
+void load() {
+    const auto* context = sge::Context::getCurrentContext();
+    assert(context);
+
+    if (!context->isExtensionAvailable("GL_ARB_bindless_texture")) {
+        return;
+    }
+
+    getTextureHandle = reinterpret_cast<GetTextureHandle>(
+        SDL_GL_GetProcAddress("glGetTextureHandleARB"));
+    makeHandleResident = reinterpret_cast<MakeHandleResident>(
+        SDL_GL_GetProcAddress("glMakeTextureHandleResidentARB"));
+    makeHandleNonResident = reinterpret_cast<MakeHandleNonResident>(
+        SDL_GL_GetProcAddress("glMakeTextureHandleNonResidentARB"));
+
+    available = getTextureHandle != nullptr && makeHandleResident != nullptr &&
+                makeHandleNonResident != nullptr;
+}
+}
+
+namespace sge::bindless {
+bool isAvailable() {
+    std::call_once(loadFlag, load);
+
+    return available;
+}
+
+std::uint64_t makeResident(const unsigned int texture) {
+    assert(available && Context::getCurrentContext());
+    const auto handle = getTextureHandle(texture);
+    makeHandleResident(handle);
+
+    return handle;
+}
+
+void makeNonResident(const std::uint64_t handle) {
+    assert(available && Context::getCurrentContext());
+    makeHandleNonResident(handle);
+}
+}
@@ -0,0 +1,50 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_BINDLESSTEXTURE_HPP
+#define SGE_BINDLESSTEXTURE_HPP
+
+#include <cstdint>
+
+namespace sge::bindless {
+// Shaders read texture handles from a "TextureHandles" storage block with
+// maxTextures entries, bound to handlesBinding
+constexpr unsigned int maxTextures    = 1024;
+constexpr unsigned int handlesBinding = 0;
+
+/**
+ * \brief Check for bindless texture support
+ *
+ *
+ * Checks if GL_ARB_bindless_texture is supported by the current context and
+ * loads its entry points the first time it is called.
+ * \return true if bindless textures can be used, false otherwise
+ */
+bool isAvailable();
+
+/**
+ * \brief Get a resident texture handle
+ * \param texture OpenGL texture name
+ * \return Resident handle of the texture
+ */
+std::uint64_t makeResident(unsigned int texture);
+
+/**
+ * \brief Make a texture handle non resident
+ * \param handle Texture handle
+ */
+void makeNonResident(std::uint64_t handle);
+}
+
+#endif//SGE_BINDLESSTEXTURE_HPP
@@ -0,0 +1,406 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "CompressedTexture.hpp"
+#include <SGE/Context.hpp>
+#include <SGE/Texture.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <glad.h>
+
+namespace {
+// GL_EXT_texture_compression_s3tc and GL_EXT_texture_sRGB formats, which are
+// not part of core OpenGL
+constexpr GLenum compressedRgbaS3tcDxt1     = 0x83F1;
+constexpr GLenum compressedRgbaS3tcDxt5     = 0x83F3;
+constexpr GLenum compressedSrgbAlphaS3tcDxt1 = 0x8C4D;
+constexpr GLenum compressedSrgbAlphaS3tcDxt5 = 0x8C4F;
+
+constexpr unsigned char ktx2Identifier[] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+constexpr std::size_t ddsHeaderSize      = 128;// Magic and DDS_HEADER
+constexpr std::size_t ddsDx10HeaderSize  = 20;
+constexpr std::uint32_t ddsMipMapCount   = 0x20000;
+constexpr std::uint32_t ddsFourCC        = 0x4;
+constexpr std::size_t ktx2HeaderSize     = 80;// Identifier, header and index
+constexpr std::size_t ktx2LevelIndexSize = 24;
+
+bool s3tcAvailable = false;
+std::once_flag s3tcFlag;
+
+std::uint32_t read32(const unsigned char* data) {
+    return static_cast<std::uint32_t>(data[0]) |
+           static_cast<std::uint32_t>(data[1]) << 8 |
+           static_cast<std::uint32_t>(data[2]) << 16 |
+           static_cast<std::uint32_t>(data[3]) << 24;
+}
+
+std::uint64_t read64(const unsigned char* data) {
+    return static_cast<std::uint64_t>(read32(data)) |
+           static_cast<std::uint64_t>(read32(data + 4)) << 32;
+}
+
+constexpr std::uint32_t fourCC(const char* code) {
+    return static_cast<std::uint32_t>(code[0]) |
+           static_cast<std::uint32_t>(code[1]) << 8 |
+           static_cast<std::uint32_t>(code[2]) << 16 |
+           static_cast<std::uint32_t>(code[3]) << 24;
+}
+
+std::size_t blockSize(const sge::compressed::Format format) {
+    return format == sge::compressed::Format::BC1 ||
+                   format == sge::compressed::Format::BC1Srgb
+               ? 8
+               : 16;
+}
+
+std::size_t levelSize(const sge::compressed::Format format,
+                      const glm::uvec2& extent) {
+    return static_cast<std::size_t>((extent.x + 3) / 4) *
+           ((extent.y + 3) / 4) * blockSize(format);
+}
+
+// Sizes above the maximum texture size are rejected before any level size is
+// computed, which keeps the block counts from overflowing
+bool isValidSize(const glm::uvec2& size) {
+    const auto maximum = sge::Texture::getMaximumSize();
+
+    return size.x > 0 && size.y > 0 && size.x <= maximum && size.y <= maximum;
+}
+
+// Level count clamped to the length of the full mipmap chain
+unsigned int clampLevels(const glm::uvec2& size, const std::uint32_t levels) {
+    unsigned int chain = 1;
+    while ((std::max(size.x, size.y) >> chain) > 0) {
+        chain++;
+    }
+
+    return std::min<std::uint32_t>(std::max(levels, 1u), chain);
+}
+
+glm::uvec2 levelExtent(const glm::uvec2& size, const unsigned int level) {
+    return glm::uvec2(std::max(size.x >> level, 1u),
+                      std::max(size.y >> level, 1u));
+}
+
+bool fromDxgi(const std::uint32_t dxgi, sge::compressed::Format& format) {
+    switch (dxgi) {
+    case 71:// DXGI_FORMAT_BC1_UNORM
+        format = sge::compressed::Format::BC1;
+        return true;
+    case 72:// DXGI_FORMAT_BC1_UNORM_SRGB
+        format = sge::compressed::Format::BC1Srgb;
+        return true;
+    case 77:// DXGI_FORMAT_BC3_UNORM
+        format = sge::compressed::Format::BC3;
+        return true;
+    case 78:// DXGI_FORMAT_BC3_UNORM_SRGB
+        format = sge::compressed::Format::BC3Srgb;
+        return true;
+    case 98:// DXGI_FORMAT_BC7_UNORM
+        format = sge::compressed::Format::BC7;
+        return true;
+    case 99:// DXGI_FORMAT_BC7_UNORM_SRGB
+        format = sge::compressed::Format::BC7Srgb;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool fromVulkan(const std::uint32_t vkFormat, sge::compressed::Format& format) {
+    switch (vkFormat) {
+    case 131:// VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case 133:// VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+        format = sge::compressed::Format::BC1;
+        return true;
+    case 132:// VK_FORMAT_BC1_RGB_SRGB_BLOCK
+    case 134:// VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+        format = sge::compressed::Format::BC1Srgb;
+        return true;
+    case 137:// VK_FORMAT_BC3_UNORM_BLOCK
+        format = sge::compressed::Format::BC3;
+        return true;
+    case 138:// VK_FORMAT_BC3_SRGB_BLOCK
+        format = sge::compressed::Format::BC3Srgb;
+        return true;
+    case 145:// VK_FORMAT_BC7_UNORM_BLOCK
+        format = sge::compressed::Format::BC7;
+        return true;
+    case 146:// VK_FORMAT_BC7_SRGB_BLOCK
+        format = sge::compressed::Format::BC7Srgb;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool readDds(const std::size_t size,
+             const unsigned char* data,
+             sge::compressed::ImageData& image) {
+    if (size < ddsHeaderSize || read32(data + 4) != 124) {
+        return false;
+    }
+
+    const auto flags       = read32(data + 8);
+    const auto formatFlags = read32(data + 80);
+    const auto code        = read32(data + 84);
+    auto offset            = ddsHeaderSize;
+
+    image.size = glm::uvec2(read32(data + 16), read32(data + 12));
+    if ((formatFlags & ddsFourCC) == 0 || !isValidSize(image.size)) {
+        return false;
+    } else if (code == fourCC("DXT1")) {
+        image.format = sge::compressed::Format::BC1;
+    } else if (code == fourCC("DXT5")) {
+        image.format = sge::compressed::Format::BC3;
+    } else if (code == fourCC("DX10")) {
+        // Only plain 2D textures (D3D10_RESOURCE_DIMENSION_TEXTURE2D with a
+        // single array element) are supported
+        if (size < ddsHeaderSize + ddsDx10HeaderSize ||
+            !fromDxgi(read32(data + ddsHeaderSize), image.format) ||
+            read32(data + ddsHeaderSize + 4) != 3 ||
+            read32(data + ddsHeaderSize + 12) > 1) {
+            return false;
+        }
+        offset += ddsDx10HeaderSize;
+    } else {
+        return false;
+    }
+
+    const auto levelCount = clampLevels(
+        image.size, (flags & ddsMipMapCount) != 0 ? read32(data + 28) : 1u);
+
+    image.levels.clear();
+    for (unsigned int i = 0; i < levelCount; i++) {
+        const auto extent = levelExtent(image.size, i);
+        const auto bytes  = levelSize(image.format, extent);
+
+        if (offset + bytes > size) {
+            return false;
+        }
+        image.levels.push_back(
+            sge::compressed::Level{data + offset, bytes, extent});
+        offset += bytes;
+    }
+
+    return true;
+}
+
+bool readKtx2(const std::size_t size,
+              const unsigned char* data,
+              sge::compressed::ImageData& image) {
+    if (size < ktx2HeaderSize || !fromVulkan(read32(data + 12), image.format)) {
+        return false;
+    }
+
+    // 2D, single layer and face, without supercompression
+    const auto depth            = read32(data + 28);
+    const auto layers           = read32(data + 32);
+    const auto faces            = read32(data + 36);
+    const auto supercompression = read32(data + 44);
+    if (depth != 0 || layers > 1 || faces != 1 || supercompression != 0) {
+        return false;
+    }
+
+    image.size = glm::uvec2(read32(data + 20), read32(data + 24));
+    if (!isValidSize(image.size)) {
+        return false;
+    }
+
+    const auto levelCount = clampLevels(image.size, read32(data + 40));
+    if (ktx2HeaderSize + levelCount * ktx2LevelIndexSize > size) {
+        return false;
+    }
+
+    image.levels.clear();
+    for (unsigned int i = 0; i < levelCount; i++) {
+        const auto* index  = data + ktx2HeaderSize + i * ktx2LevelIndexSize;
+        const auto offset  = read64(index);
+        const auto length  = read64(index + 8);
+        const auto extent  = levelExtent(image.size, i);
+
+        if (offset > size || length > size - offset ||
+            length < levelSize(image.format, extent)) {
+            return false;
+        }
+        image.levels.push_back(sge::compressed::Level{
+            data + offset, levelSize(image.format, extent), extent});
+    }
+
+    return true;
+}
+
+void decodeColors(const unsigned char* block,
+                  const bool opaque,
+                  unsigned char colors[4][4]) {
+    const auto c0 = static_cast<std::uint16_t>(block[0] | block[1] << 8);
+    const auto c1 = static_cast<std::uint16_t>(block[2] | block[3] << 8);
+
+    for (unsigned int i = 0; i < 2; i++) {
+        const auto c = i == 0 ? c0 : c1;
+
+        colors[i][0] = static_cast<unsigned char>((c >> 11 & 31) * 255 / 31);
+        colors[i][1] = static_cast<unsigned char>((c >> 5 & 63) * 255 / 63);
+        colors[i][2] = static_cast<unsigned char>((c & 31) * 255 / 31);
+        colors[i][3] = 255;
+    }
+
+    for (unsigned int i = 0; i < 3; i++) {
+        if (c0 > c1 || opaque) {
+            colors[2][i] = static_cast<unsigned char>(
+                (2 * colors[0][i] + colors[1][i]) / 3);
+            colors[3][i] = static_cast<unsigned char>(
+                (colors[0][i] + 2 * colors[1][i]) / 3);
+        } else {
+            colors[2][i] =
+                static_cast<unsigned char>((colors[0][i] + colors[1][i]) / 2);
+            colors[3][i] = 0;
+        }
+    }
+    colors[2][3] = 255;
+    colors[3][3] = c0 > c1 || opaque ? 255 : 0;
+}
+
+void decodeAlphas(const unsigned char* block, unsigned char alphas[8]) {
+    alphas[0] = block[0];
+    alphas[1] = block[1];
+
+    if (alphas[0] > alphas[1]) {
+        for (unsigned int i = 1; i < 7; i++) {
+            alphas[i + 1] = static_cast<unsigned char>(
+                ((7 - i) * alphas[0] + i * alphas[1]) / 7);
+        }
+    } else {
+        for (unsigned int i = 1; i < 5; i++) {
+            alphas[i + 1] = static_cast<unsigned char>(
+                ((5 - i) * alphas[0] + i * alphas[1]) / 5);
+        }
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+}
+}
+
+namespace sge::compressed {
+bool isContainer(const std::size_t size, const void* data) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+
+    return (size >= 4 && std::memcmp(bytes, "DDS ", 4) == 0) ||
+           (size >= sizeof(ktx2Identifier) &&
+            std::memcmp(bytes, ktx2Identifier, sizeof(ktx2Identifier)) == 0);
+}
+
+bool read(const std::size_t size, const void* data, ImageData& image) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    bool valid        = false;
+
+    if (!isContainer(size, data)) {
+        return false;
+    }
+
+    try {
+        valid = bytes[0] == 'D' ? readDds(size, bytes, image)
+                                : readKtx2(size, bytes, image);
+    } catch (...) {
+        return false;
+    }
+
+    return valid && image.size.x != 0 && image.size.y != 0;
+}
+
+unsigned int getInternalFormat(const Format format) {
+    switch (format) {
+    case Format::BC1:
+        return compressedRgbaS3tcDxt1;
+    case Format::BC1Srgb:
+        return compressedSrgbAlphaS3tcDxt1;
+    case Format::BC3:
+        return compressedRgbaS3tcDxt5;
+    case Format::BC3Srgb:
+        return compressedSrgbAlphaS3tcDxt5;
+    case Format::BC7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    case Format::BC7Srgb:
+    default:
+        return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+    }
+}
+
+bool isSupported(const Format format) {
+    if (format == Format::BC7 || format == Format::BC7Srgb) {
+        return true;
+    }
+
+    std::call_once(s3tcFlag, []() {
+        const auto* context = Context::getCurrentContext();
+        assert(context);
+
+        s3tcAvailable =
+            context->isExtensionAvailable("GL_EXT_texture_compression_s3tc");
+    });
+
+    return s3tcAvailable;
+}
+
+void decompress(const Format format,
+                const Level& level,
+                unsigned char* pixels) {
+    assert(format != Format::BC7 && format != Format::BC7Srgb);
+
+    const auto hasAlpha  = format == Format::BC3 || format == Format::BC3Srgb;
+    const auto blockSize = hasAlpha ? 16 : 8;
+    const auto* block    = level.data;
+
+    for (unsigned int by = 0; by < level.extent.y; by += 4) {
+        for (unsigned int bx = 0; bx < level.extent.x; bx += 4) {
+            unsigned char colors[4][4];
+            unsigned char alphas[8];
+            const auto* colorBlock = hasAlpha ? block + 8 : block;
+            const auto indices     = read32(colorBlock + 4);
+            // 48 bits of 3 bit alpha indices
+            const auto alphaBits =
+                hasAlpha ? read64(block) >> 16 : std::uint64_t(0);
+
+            decodeColors(colorBlock, hasAlpha, colors);
+            if (hasAlpha) {
+                decodeAlphas(block, alphas);
+            }
+
+            for (unsigned int y = 0; y < 4 && by + y < level.extent.y; y++) {
+                for (unsigned int x = 0; x < 4 && bx + x < level.extent.x;
+                     x++) {
+                    const auto i     = y * 4 + x;
+                    const auto index = (static_cast<std::size_t>(by) + y) *
+                                           level.extent.x +
+                                       bx + x;
+                    auto* pixel      = pixels + index * 4;
+                    const auto* c    = colors[indices >> (i * 2) & 3];
+
+                    pixel[0] = c[0];
+                    pixel[1] = c[1];
+                    pixel[2] = c[2];
+                    pixel[3] = hasAlpha ? alphas[alphaBits >> (i * 3) & 7]
+                                        : c[3];
+                }
+            }
+
+            block += blockSize;
+        }
+    }
+}
+}
@@ -0,0 +1,109 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_COMPRESSEDTEXTURE_HPP
+#define SGE_COMPRESSEDTEXTURE_HPP
+
+#include <glm/vec2.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace sge::compressed {
+/**
+ * \brief Block compression format
+ */
+enum class Format {
+    BC1,     ///< 4 bpp RGB with 1 bit alpha (DXT1)
+    BC1Srgb, ///< BC1 with sRGB color
+    BC3,     ///< 8 bpp RGBA with interpolated alpha (DXT5)
+    BC3Srgb, ///< BC3 with sRGB color
+    BC7,     ///< 8 bpp high quality RGBA (BPTC)
+    BC7Srgb  ///< BC7 with sRGB color
+};
+
+/**
+ * \brief Stored mipmap level
+ */
+struct Level {
+    const unsigned char* data;///< Pointer to the blocks of the level
+    std::size_t size;         ///< Size of the blocks in bytes
+    glm::uvec2 extent;        ///< Size of the level in pixels
+};
+
+/**
+ * \brief Compressed image
+ *
+ *
+ * Block compressed image read from a DDS or KTX2 container. The levels point
+ * into the container memory, which must outlive the image.
+ */
+struct ImageData {
+    Format format;            ///< Block compression format
+    glm::uvec2 size;          ///< Size of the first level in pixels
+    std::vector<Level> levels;///< Stored levels, largest first
+};
+
+/**
+ * \brief Check for a compressed container
+ * \param size Size of the memory buffer
+ * \param data Pointer to the memory buffer
+ * \return true if the buffer starts with a DDS or KTX2 signature
+ */
+bool isContainer(std::size_t size, const void* data);
+
+/**
+ * \brief Read a compressed container
+ *
+ *
+ * Reads the header of a DDS or KTX2 container holding a single 2D image in a
+ * supported format, without copying the blocks.
+ * \param size Size of the memory buffer
+ * \param data Pointer to the memory buffer
+ * \param image Image receiving the format and levels
+ * \return true on success, false if the container is invalid or unsupported
+ */
+bool read(std::size_t size, const void* data, ImageData& image);
+
+/**
+ * \brief Get OpenGL internal format
+ * \param format Block compression format
+ * \return OpenGL compressed internal format
+ */
+unsigned int getInternalFormat(Format format);
+
+/**
+ * \brief Check for hardware support
+ *
+ *
+ * BC7 is core since OpenGL 4.2, while BC1 and BC3 need
+ * GL_EXT_texture_compression_s3tc, checked on the first call.
+ * \param format Block compression format
+ * \return true if the current context can sample the format
+ */
+bool isSupported(Format format);
+
+/**
+ * \brief Decompress level
+ *
+ *
+ * Decodes the blocks of a BC1 or BC3 level to RGBA pixels, used when the
+ * format is not supported by the driver.
+ * \param format Block compression format (BC1 or BC3)
+ * \param level Level to decode
+ * \param pixels Buffer receiving extent.x * extent.y RGBA pixels
+ */
+void decompress(Format format, const Level& level, unsigned char* pixels);
+}
+
+#endif//SGE_COMPRESSEDTEXTURE_HPP
@@ -18,6 +18,7 @@
 #include <SGE/Log.hpp>
 #include <string>
 #include <mutex>
+#include <atomic>
 #include <cassert>
 #include <glad.h>
 #define SDL_MAIN_HANDLED
@@ -33,6 +34,55 @@ int sharedCount                   = 0;
 std::recursive_mutex sharedMutex;
 bool loadedGL = false;
 std::mutex loadedMutex;
+std::atomic<unsigned int> deletedObjects(0);
+
+constexpr unsigned int cachedTextureUnits = 32;
+constexpr unsigned int unknownObject      = ~0u;
+
+// Shadow of the OpenGL state changed by the library. Unknown values never
+// match, so the first call after a reset always reaches OpenGL. Deleting
+// objects may free names that get reused, so the bindings are forgotten
+// whenever any context deletes something.
+struct StateCache {
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int elementBuffer;
+    unsigned int textures[cachedTextureUnits];
+    int viewport[4];
+    int depthTest;
+    unsigned int deletedObjects;
+    std::uint64_t elided;
+};
+
+void resetState(StateCache& state) {
+    state.program       = unknownObject;
+    state.vertexArray   = unknownObject;
+    state.elementBuffer = unknownObject;
+    for (auto& texture : state.textures) {
+        texture = unknownObject;
+    }
+    state.viewport[0]    = -1;
+    state.viewport[1]    = -1;
+    state.viewport[2]    = -1;
+    state.viewport[3]    = -1;
+    state.depthTest      = -1;
+    state.deletedObjects = deletedObjects.load(std::memory_order_relaxed);
+}
+
+StateCache& getState(void* state) {
+    auto& s = *static_cast<StateCache*>(state);
+    if (s.deletedObjects != deletedObjects.load(std::memory_order_relaxed)) {
+        s.program       = unknownObject;
+        s.vertexArray   = unknownObject;
+        s.elementBuffer = unknownObject;
+        for (auto& texture : s.textures) {
+            texture = unknownObject;
+        }
+        s.deletedObjects = deletedObjects.load(std::memory_order_relaxed);
+    }
+
+    return s;
+}
 
 const char* sourceToString(const GLenum source) {
     switch (source) {
@@ -121,12 +171,14 @@ void GLAPIENTRY messageCallback(const GLenum source,
 
 namespace sge {
 Context::Context(const ContextSettings& settings)
-    : m_handle(nullptr), m_windowHandle(nullptr), m_sharedWindow(false) {
+    : m_handle(nullptr), m_windowHandle(nullptr), m_sharedWindow(false),
+      m_state(nullptr) {
     create(nullptr, settings);
 }
 
 Context::Context(const Window& window, const ContextSettings& settings)
-    : m_handle(nullptr), m_windowHandle(nullptr), m_sharedWindow(true) {
+    : m_handle(nullptr), m_windowHandle(nullptr), m_sharedWindow(true),
+      m_state(nullptr) {
     create(window.m_handle, settings);
 }
 
@@ -149,6 +201,8 @@ Context::~Context() {
             shared = nullptr;
         }
     }
+
+    delete static_cast<StateCache*>(m_state);
 }
 
 const ContextSettings& Context::getContextSettings() const {
@@ -295,9 +349,12 @@ void Context::create(void* winHandle, const ContextSettings& settings) {
         glDebugMessageCallback(messageCallback, nullptr);
     }
 
-    m_settings.vsync        = settings.vsync;
-    m_settings.debugContext = settings.debugContext;
-    m_settings.srgbCapable  = settings.srgbCapable;
+    m_settings.vsync            = settings.vsync;
+    m_settings.debugContext     = settings.debugContext;
+    m_settings.srgbCapable      = settings.srgbCapable;
+    m_settings.batchSegments    = settings.batchSegments;
+    m_settings.batchCapacity    = settings.batchCapacity;
+    m_settings.adaptiveBatching = settings.adaptiveBatching;
     glGetIntegerv(GL_SAMPLES, &m_settings.samples);
     glGetFramebufferAttachmentParameteriv(GL_DRAW_FRAMEBUFFER,
                                           GL_FRONT_LEFT,
@@ -325,6 +382,15 @@ void Context::create(void* winHandle, const ContextSettings& settings) {
         GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE,
         &m_settings.stencilBits);
 
+    try {
+        auto* state = new StateCache;
+        resetState(*state);
+        state->elided = 0;
+        m_state       = state;
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
     active = this;
 }
 
@@ -366,4 +432,112 @@ void Context::setSharedContextCurrent() {
         }
     }
 }
+
+std::uint64_t Context::getElidedStateChanges() const {
+    return static_cast<StateCache*>(m_state)->elided;
+}
+
+void Context::resetStateCache() {
+    resetState(*static_cast<StateCache*>(m_state));
+}
+
+void Context::useProgram(const unsigned int program) {
+    assert(active == this);
+    auto& state = getState(m_state);
+
+    if (state.program == program) {
+        state.elided++;
+        return;
+    }
+
+    glUseProgram(program);
+    state.program = program;
+}
+
+void Context::bindVertexArray(const unsigned int vertexArray) {
+    assert(active == this);
+    auto& state = getState(m_state);
+
+    if (state.vertexArray == vertexArray) {
+        state.elided++;
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+    // The element buffer binding is part of the vertex array state
+    state.vertexArray   = vertexArray;
+    state.elementBuffer = unknownObject;
+}
+
+void Context::bindElementBuffer(const unsigned int buffer) {
+    assert(active == this);
+    auto& state = getState(m_state);
+
+    if (state.elementBuffer == buffer) {
+        state.elided++;
+        return;
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    state.elementBuffer = buffer;
+}
+
+void Context::bindTexture(const unsigned int unit, const unsigned int texture) {
+    assert(active == this);
+    auto& state = getState(m_state);
+
+    if (unit >= cachedTextureUnits) {
+        glBindTextureUnit(unit, texture);
+        return;
+    }
+
+    if (state.textures[unit] == texture) {
+        state.elided++;
+        return;
+    }
+
+    glBindTextureUnit(unit, texture);
+    state.textures[unit] = texture;
+}
+
+void Context::setViewport(const int x,
+                          const int y,
+                          const int width,
+                          const int height) {
+    assert(active == this);
+    auto& state = getState(m_state);
+
+    if (state.viewport[0] == x && state.viewport[1] == y &&
+        state.viewport[2] == width && state.viewport[3] == height) {
+        state.elided++;
+        return;
+    }
+
+    glViewport(x, y, width, height);
+    state.viewport[0] = x;
+    state.viewport[1] = y;
+    state.viewport[2] = width;
+    state.viewport[3] = height;
+}
+
+void Context::setDepthTest(const bool enabled) {
+    assert(active == this);
+    auto& state = getState(m_state);
+
+    if (state.depthTest == static_cast<int>(enabled)) {
+        state.elided++;
+        return;
+    }
+
+    if (enabled) {
+        glEnable(GL_DEPTH_TEST);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+    state.depthTest = static_cast<int>(enabled);
+}
+
+void Context::objectDeleted() {
+    deletedObjects.fetch_add(1, std::memory_order_relaxed);
+}
 }
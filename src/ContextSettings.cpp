@@ -24,11 +24,15 @@ ContextSettings::ContextSettings(const bool vsync,
                                  const int redBits,
                                  const int greenBits,
                                  const int blueBits,
-                                 const int alphaBits)
+                                 const int alphaBits,
+                                 const unsigned int batchSegments,
+                                 const unsigned int batchCapacity,
+                                 const bool adaptiveBatching)
     : vsync(vsync), samples(samples), debugContext(debugContext),
       srgbCapable(srgbCapable), depthBits(depthBits), stencilBits(stencilBits),
       redBits(redBits), greenBits(greenBits), blueBits(blueBits),
-      alphaBits(alphaBits) {
+      alphaBits(alphaBits), batchSegments(batchSegments),
+      batchCapacity(batchCapacity), adaptiveBatching(adaptiveBatching) {
 #ifdef SGE_DEBUG
     this->debugContext = true;
 #endif
@@ -48,6 +48,14 @@ Image::~Image() {
 }
 
 Image& Image::operator=(Image&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    if (m_data != nullptr) {
+        stbi_image_free(m_data);
+    }
+
     m_data = other.m_data;
     m_size = other.m_size;
 
@@ -0,0 +1,77 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/ImageLoader.hpp>
+#include <SGE/Application.hpp>
+#include <SGE/Image.hpp>
+#include <SGE/JobSystem.hpp>
+#include <SGE/Log.hpp>
+#include "ImageUtils.hpp"
+#include <vector>
+
+namespace sge {
+std::size_t ImageLoader::loadAll(const char* const* paths,
+                                 const std::size_t count,
+                                 Image* images,
+                                 Timing* timings) {
+    return loadAll(Application::getJobSystem(), paths, count, images, timings);
+}
+
+std::size_t ImageLoader::loadAll(JobSystem& jobSystem,
+                                 const char* const* paths,
+                                 const std::size_t count,
+                                 Image* images,
+                                 Timing* timings) {
+    std::vector<std::uint8_t> failed;
+
+    try {
+        failed.resize(count, 0);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    jobSystem.parallelFor(
+        count,
+        1,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (auto i = begin; i < end; i++) {
+                Timing timing{};
+
+                if (!imageutils::readImage(paths[i], images[i], timing)) {
+                    images[i] = Image();
+                    failed[i] = 1;
+                }
+
+                if (timings != nullptr) {
+                    timings[i] = timing;
+                }
+            }
+        });
+
+    // Logged afterwards, as messages written from several threads at once
+    // could interleave
+    std::size_t loaded = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (failed[i] != 0) {
+            Log::general << Log::MessageType::Warning
+                         << "Failed to load image: " << paths[i]
+                         << Log::Operation::Endl;
+        } else {
+            loaded++;
+        }
+    }
+
+    return loaded;
+}
+}
@@ -0,0 +1,94 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ImageUtils.hpp"
+#include <SGE/Application.hpp>
+#include <SGE/Filesystem.hpp>
+#include <SGE/Image.hpp>
+#include <SGE/InputFile.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Kept by every thread between files, so reading needs no allocation once it
+// has grown to the largest file
+thread_local std::vector<unsigned char> readBuffer;
+
+float millisecondsSince(const Clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(Clock::now() - start)
+        .count();
+}
+}
+
+namespace sge::imageutils {
+bool readImage(const char* path, Image& image, ImageLoader::Timing& timing) {
+    const auto readStart = Clock::now();
+
+    timing.read   = 0.0f;
+    timing.decode = 0.0f;
+    if (!Filesystem::exists(path)) {
+        return false;
+    }
+
+    const auto fileSize = Filesystem::getFileSize(path);
+    InputFile file;
+    if (fileSize == 0 || !file.open(path)) {
+        return false;
+    }
+
+    try {
+        if (readBuffer.size() < fileSize) {
+            readBuffer.resize(fileSize);
+        }
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+    const auto read = file.read(fileSize, readBuffer.data());
+    timing.read     = millisecondsSince(readStart);
+
+    const auto decodeStart = Clock::now();
+    const auto loaded      = image.loadFromMemory(read, readBuffer.data());
+    timing.decode          = millisecondsSince(decodeStart);
+
+    return loaded;
+}
+
+void padPixels(const unsigned char* pixels,
+               const glm::uvec2& size,
+               const unsigned int padding,
+               std::vector<unsigned char>& padded) {
+    const auto width  = size.x + padding * 2;
+    const auto height = size.y + padding * 2;
+
+    padded.resize(static_cast<std::size_t>(width) * height * 4);
+    for (unsigned int y = 0; y < height; y++) {
+        const auto sourceY =
+            std::min(y > padding ? y - padding : 0u, size.y - 1);
+        const auto* source = pixels + static_cast<std::size_t>(sourceY) *
+                                          size.x * 4;
+        auto* row = padded.data() + static_cast<std::size_t>(y) * width * 4;
+
+        for (unsigned int x = 0; x < padding; x++) {
+            std::memcpy(row + x * 4, source, 4);
+            std::memcpy(row + (padding + size.x + x) * 4,
+                        source + (size.x - 1) * 4,
+                        4);
+        }
+        std::memcpy(row + padding * 4, source, size.x * 4);
+    }
+}
+}
@@ -0,0 +1,57 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_IMAGEUTILS_HPP
+#define SGE_IMAGEUTILS_HPP
+
+#include <SGE/ImageLoader.hpp>
+#include <glm/vec2.hpp>
+#include <vector>
+
+namespace sge {
+class Image;
+}
+
+namespace sge::imageutils {
+/**
+ * \brief Read image
+ *
+ *
+ * Reads and decodes a virtual file into an image. Can be called from any
+ * thread; each thread keeps its read buffer between calls.
+ * \param path Path to the virtual file
+ * \param image Image to load into
+ * \param timing Time spent reading and decoding the file
+ * \return true on success, false otherwise
+ */
+bool readImage(const char* path, Image& image, ImageLoader::Timing& timing);
+
+/**
+ * \brief Pad pixels
+ *
+ *
+ * Copies RGBA pixels to the center of a larger area and repeats the edge
+ * pixels into the padding around them.
+ * \param pixels Pixels to copy, row by row
+ * \param size Size of the pixel area
+ * \param padding Number of pixels added on each side
+ * \param padded Vector receiving the padded pixels
+ */
+void padPixels(const unsigned char* pixels,
+               const glm::uvec2& size,
+               unsigned int padding,
+               std::vector<unsigned char>& padded);
+}
+
+#endif//SGE_IMAGEUTILS_HPP
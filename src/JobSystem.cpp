@@ -0,0 +1,300 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/JobSystem.hpp>
+#include <SGE/Application.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+struct QueuedJob {
+    sge::JobSystem::Job job;
+    void* data;
+    std::size_t begin;
+    std::size_t end;
+    std::atomic<std::uint32_t>* counter;
+    const sge::JobCounter* dependency;
+};
+
+struct JobQueue {
+    std::mutex mutex;
+    std::deque<QueuedJob> jobs;
+};
+
+struct JobData {
+    std::unique_ptr<JobQueue[]> queues;// Queue 0 belongs to other threads
+    unsigned int queueCount;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> queued;
+    std::atomic<bool> stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::mutex deferredMutex;
+    std::vector<QueuedJob> deferred;
+};
+
+thread_local const JobData* workerOwner = nullptr;
+thread_local unsigned int workerQueue   = 0;
+
+unsigned int currentQueue(const JobData& data) {
+    return workerOwner == &data ? workerQueue : 0;
+}
+
+void push(JobData& data, const QueuedJob& job) {
+    auto& queue = data.queues[currentQueue(data)];
+
+    // Counted before the job is visible so the count never drops below zero
+    data.queued++;
+    try {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    } catch (...) {
+        sge::Application::crashApplication("Failed to queue job");
+    }
+
+    // Taking the lock orders the notification after a worker that found no
+    // work has started waiting
+    { std::lock_guard<std::mutex> lock(data.sleepMutex); }
+    data.wake.notify_one();
+}
+
+bool pop(JobData& data, QueuedJob& job) {
+    const auto own = currentQueue(data);
+
+    for (unsigned int i = 0; i < data.queueCount; i++) {
+        auto& queue = data.queues[(own + i) % data.queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.jobs.empty()) {
+            continue;
+        }
+
+        // Workers run their newest job first and steal the oldest ones. Queue
+        // 0 is always first in first out, so with no workers jobs run in the
+        // order they were submitted
+        if (i == 0 && own != 0) {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        } else {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        data.queued--;
+
+        return true;
+    }
+
+    return false;
+}
+
+void releaseDeferred(JobData& data) {
+    std::vector<QueuedJob> ready;
+
+    try {
+        std::lock_guard<std::mutex> lock(data.deferredMutex);
+        const auto first = std::stable_partition(
+            data.deferred.begin(),
+            data.deferred.end(),
+            [](const QueuedJob& job) { return !job.dependency->isDone(); });
+
+        ready.assign(first, data.deferred.end());
+        data.deferred.erase(first, data.deferred.end());
+    } catch (...) {
+        sge::Application::crashApplication("Failed to release jobs");
+    }
+
+    for (const auto& job : ready) {
+        push(data, job);
+    }
+}
+
+void schedule(JobData& data, const QueuedJob& job) {
+    if (job.dependency != nullptr) {
+        // Checked under the lock so the dependency can't finish between the
+        // check and the job being deferred
+        std::unique_lock<std::mutex> lock(data.deferredMutex);
+
+        if (!job.dependency->isDone()) {
+            try {
+                data.deferred.push_back(job);
+            } catch (...) {
+                sge::Application::crashApplication("Failed to defer job");
+            }
+
+            return;
+        }
+    }
+
+    push(data, job);
+}
+
+void execute(JobData& data, const QueuedJob& job) {
+    job.job(job.data, job.begin, job.end);
+
+    if (job.counter != nullptr && job.counter->fetch_sub(1) == 1) {
+        releaseDeferred(data);
+    }
+}
+
+void workerLoop(JobData& data, const unsigned int queue) {
+    workerOwner = &data;
+    workerQueue = queue;
+
+    QueuedJob job{};
+    while (true) {
+        if (pop(data, job)) {
+            execute(data, job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(data.sleepMutex);
+        if (data.stopping && data.queued == 0) {
+            return;
+        }
+        data.wake.wait(lock, [&data]() {
+            return data.stopping || data.queued > 0;
+        });
+    }
+}
+}
+
+namespace sge {
+JobCounter::JobCounter() : m_value(0) {
+}
+
+bool JobCounter::isDone() const {
+    return m_value.load() == 0;
+}
+
+JobSystem::JobSystem() : m_data(nullptr) {
+    const auto threads = std::thread::hardware_concurrency();
+
+    start(threads > 1 ? threads - 1 : 0);
+}
+
+JobSystem::JobSystem(const unsigned int workerCount) : m_data(nullptr) {
+    start(workerCount);
+}
+
+JobSystem::~JobSystem() {
+    auto* data = static_cast<JobData*>(m_data);
+
+    {
+        std::lock_guard<std::mutex> lock(data->sleepMutex);
+        data->stopping = true;
+    }
+    data->wake.notify_all();
+
+    for (auto& worker : data->workers) {
+        worker.join();
+    }
+
+    delete data;
+}
+
+void JobSystem::submit(const Job job,
+                       void* data,
+                       const std::size_t begin,
+                       const std::size_t end,
+                       JobCounter* counter,
+                       const JobCounter* dependency) {
+    auto* jobData = static_cast<JobData*>(m_data);
+
+    if (counter != nullptr) {
+        counter->m_value++;
+    }
+
+    schedule(*jobData,
+             QueuedJob{job,
+                       data,
+                       begin,
+                       end,
+                       counter != nullptr ? &counter->m_value : nullptr,
+                       dependency});
+}
+
+void JobSystem::parallelFor(const std::size_t count,
+                            const std::size_t grain,
+                            const Job job,
+                            void* data,
+                            JobCounter* counter,
+                            const JobCounter* dependency) {
+    const auto step = std::max<std::size_t>(grain, 1);
+
+    if (counter == nullptr) {
+        // Ranges fitting in one job don't need to go through the queues
+        if (count <= step && (dependency == nullptr || dependency->isDone())) {
+            job(data, 0, count);
+            return;
+        }
+
+        JobCounter local;
+        parallelFor(count, grain, job, data, &local, dependency);
+        wait(local);
+        return;
+    }
+
+    for (std::size_t begin = 0; begin < count; begin += step) {
+        submit(job,
+               data,
+               begin,
+               std::min(begin + step, count),
+               counter,
+               dependency);
+    }
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    auto* data = static_cast<JobData*>(m_data);
+
+    QueuedJob job{};
+    while (!counter.isDone()) {
+        if (pop(*data, job)) {
+            execute(*data, job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+unsigned int JobSystem::getWorkerCount() const {
+    return static_cast<unsigned int>(
+        static_cast<JobData*>(m_data)->workers.size());
+}
+
+void JobSystem::start(const unsigned int workerCount) {
+    JobData* data = nullptr;
+
+    try {
+        data             = new JobData;
+        data->queueCount = workerCount + 1;
+        data->queues     = std::make_unique<JobQueue[]>(data->queueCount);
+        data->queued     = 0;
+        data->stopping   = false;
+        m_data           = data;
+
+        data->workers.reserve(workerCount);
+        for (unsigned int i = 1; i <= workerCount; i++) {
+            data->workers.emplace_back(workerLoop, std::ref(*data), i);
+        }
+    } catch (...) {
+        Application::crashApplication("Failed to start job system");
+    }
+}
+}
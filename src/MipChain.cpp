@@ -0,0 +1,465 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/MipChain.hpp>
+#include <SGE/Application.hpp>
+#include <SGE/Filesystem.hpp>
+#include <SGE/Image.hpp>
+#include <SGE/InputFile.hpp>
+#include "SimdConfig.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace {
+constexpr char fileMagic[]              = {'S', 'M', 'I', 'P'};
+constexpr std::uint32_t fileVersion     = 1;
+constexpr std::size_t fileHeaderSize    = 20;
+constexpr float kaiserRadius            = 3.0f;// In destination pixels
+constexpr float kaiserAlpha             = 4.0f;
+constexpr unsigned int linearToSrgbSize = 4096;
+
+struct ChainData {
+    std::vector<unsigned char> pixels;
+    std::vector<std::size_t> offsets;
+    std::vector<glm::uvec2> sizes;
+};
+
+// Source pixel and weight contributing to a destination pixel
+struct Tap {
+    unsigned int index;
+    float weight;
+};
+
+struct Taps {
+    std::vector<Tap> taps;
+    std::vector<std::size_t> first;// Per destination pixel, plus the end
+};
+
+struct ColorTables {
+    float toLinear[256];
+    unsigned char toSrgb[linearToSrgbSize];
+};
+
+const ColorTables& getColorTables() {
+    static const ColorTables tables = []() {
+        ColorTables t{};
+
+        for (unsigned int i = 0; i < 256; i++) {
+            const auto c  = static_cast<float>(i) / 255.0f;
+            t.toLinear[i] = c <= 0.04045f
+                                ? c / 12.92f
+                                : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (unsigned int i = 0; i < linearToSrgbSize; i++) {
+            const auto l = static_cast<float>(i) / (linearToSrgbSize - 1);
+            const auto c = l <= 0.0031308f
+                               ? l * 12.92f
+                               : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            t.toSrgb[i]  = static_cast<unsigned char>(c * 255.0f + 0.5f);
+        }
+
+        return t;
+    }();
+
+    return tables;
+}
+
+unsigned int levelCount(const glm::uvec2& size) {
+    return 1 + static_cast<unsigned int>(
+                   std::floor(std::log2(std::max(size.x, size.y))));
+}
+
+glm::uvec2 nextLevel(const glm::uvec2& size) {
+    return glm::uvec2(std::max(size.x / 2, 1u), std::max(size.y / 2, 1u));
+}
+
+// Zeroth order modified Bessel function of the first kind
+float besselI0(const float x) {
+    auto sum  = 1.0f;
+    auto term = 1.0f;
+
+    for (unsigned int k = 1; k < 16; k++) {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+float kernel(const sge::MipChain::Filter filter, const float t) {
+    if (filter == sge::MipChain::Filter::Box) {
+        return std::abs(t) <= 0.5f ? 1.0f : 0.0f;
+    }
+
+    if (std::abs(t) >= kaiserRadius) {
+        return 0.0f;
+    }
+
+    const auto x      = t * 3.14159265f;
+    const auto sinc   = t == 0.0f ? 1.0f : std::sin(x) / x;
+    const auto r      = t / kaiserRadius;
+    const auto window = besselI0(kaiserAlpha * std::sqrt(1.0f - r * r)) /
+                        besselI0(kaiserAlpha);
+
+    return sinc * window;
+}
+
+// Weights of the source pixels for every destination pixel, with the source
+// edge pixels repeated past the border
+void computeTaps(const sge::MipChain::Filter filter,
+                 const unsigned int source,
+                 const unsigned int destination,
+                 Taps& taps) {
+    const auto scale  = static_cast<float>(source) / destination;
+    const auto radius =
+        (filter == sge::MipChain::Filter::Box ? 0.5f : kaiserRadius) * scale;
+
+    taps.taps.clear();
+    taps.first.clear();
+    for (unsigned int i = 0; i < destination; i++) {
+        const auto center = (i + 0.5f) * scale;
+        const auto begin  = static_cast<int>(std::floor(center - radius));
+        const auto end    = static_cast<int>(std::ceil(center + radius));
+        const auto first  = taps.taps.size();
+        auto sum          = 0.0f;
+
+        taps.first.push_back(first);
+        for (auto x = begin; x <= end; x++) {
+            const auto weight = kernel(filter, (x + 0.5f - center) / scale);
+            if (weight == 0.0f) {
+                continue;
+            }
+
+            const auto index = static_cast<unsigned int>(
+                std::clamp(x, 0, static_cast<int>(source) - 1));
+            taps.taps.push_back(Tap{index, weight});
+            sum += weight;
+        }
+
+        for (auto j = first; j < taps.taps.size(); j++) {
+            taps.taps[j].weight /= sum;
+        }
+    }
+    taps.first.push_back(taps.taps.size());
+}
+
+// Adds weighted RGBA float pixels to a destination
+void addScaled(float* destination,
+               const float* source,
+               const float weight,
+               const std::size_t pixels) {
+#ifdef SGE_SSE
+    const auto w = _mm_set1_ps(weight);
+    for (std::size_t i = 0; i < pixels * 4; i += 4) {
+        _mm_storeu_ps(destination + i,
+                      _mm_add_ps(_mm_loadu_ps(destination + i),
+                                 _mm_mul_ps(w, _mm_loadu_ps(source + i))));
+    }
+#else
+    for (std::size_t i = 0; i < pixels * 4; i++) {
+        destination[i] += weight * source[i];
+    }
+#endif
+}
+
+void downsample(const sge::MipChain::Filter filter,
+                const std::vector<float>& source,
+                const glm::uvec2& sourceSize,
+                std::vector<float>& destination,
+                const glm::uvec2& destinationSize) {
+    Taps horizontal;
+    Taps vertical;
+    std::vector<float> rows(
+        static_cast<std::size_t>(destinationSize.x) * sourceSize.y * 4, 0.0f);
+
+    computeTaps(filter, sourceSize.x, destinationSize.x, horizontal);
+    computeTaps(filter, sourceSize.y, destinationSize.y, vertical);
+    destination.assign(
+        static_cast<std::size_t>(destinationSize.x) * destinationSize.y * 4,
+        0.0f);
+
+    for (std::size_t y = 0; y < sourceSize.y; y++) {
+        const auto* sourceRow = source.data() + y * sourceSize.x * 4;
+        auto* row             = rows.data() + y * destinationSize.x * 4;
+
+        for (std::size_t x = 0; x < destinationSize.x; x++) {
+            for (auto i = horizontal.first[x]; i < horizontal.first[x + 1];
+                 i++) {
+                const auto& tap = horizontal.taps[i];
+                addScaled(row + x * 4,
+                          sourceRow + tap.index * 4,
+                          tap.weight,
+                          1);
+            }
+        }
+    }
+
+    // Whole rows are accumulated at once, keeping the accesses sequential
+    for (std::size_t y = 0; y < destinationSize.y; y++) {
+        auto* row = destination.data() + y * destinationSize.x * 4;
+
+        for (auto i = vertical.first[y]; i < vertical.first[y + 1]; i++) {
+            const auto& tap = vertical.taps[i];
+            addScaled(row,
+                      rows.data() +
+                          static_cast<std::size_t>(tap.index) *
+                              destinationSize.x * 4,
+                      tap.weight,
+                      destinationSize.x);
+        }
+    }
+}
+
+void toFloat(const unsigned char* pixels,
+             const std::size_t count,
+             const bool srgb,
+             std::vector<float>& values) {
+    const auto& tables = getColorTables();
+
+    values.resize(count * 4);
+    for (std::size_t i = 0; i < count * 4; i++) {
+        values[i] = srgb && i % 4 != 3 ? tables.toLinear[pixels[i]]
+                                       : pixels[i] / 255.0f;
+    }
+}
+
+void toBytes(const std::vector<float>& values,
+             const bool srgb,
+             unsigned char* pixels) {
+    const auto& tables = getColorTables();
+
+    for (std::size_t i = 0; i < values.size(); i++) {
+        // Negative lobes of the Kaiser filter can leave the [0, 1] range
+        const auto v = std::clamp(values[i], 0.0f, 1.0f);
+
+        if (srgb && i % 4 != 3) {
+            pixels[i] = tables.toSrgb[static_cast<unsigned int>(
+                v * (linearToSrgbSize - 1) + 0.5f)];
+        } else {
+            pixels[i] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+        }
+    }
+}
+
+std::uint32_t read32(const unsigned char* data) {
+    return static_cast<std::uint32_t>(data[0]) |
+           static_cast<std::uint32_t>(data[1]) << 8 |
+           static_cast<std::uint32_t>(data[2]) << 16 |
+           static_cast<std::uint32_t>(data[3]) << 24;
+}
+
+void write32(std::ofstream& file, const std::uint32_t value) {
+    const char bytes[] = {static_cast<char>(value & 0xFF),
+                          static_cast<char>(value >> 8 & 0xFF),
+                          static_cast<char>(value >> 16 & 0xFF),
+                          static_cast<char>(value >> 24 & 0xFF)};
+
+    file.write(bytes, sizeof(bytes));
+}
+
+// Lays out the levels of a chain with the given base size, returns 0 when the
+// total byte size does not fit in a size_t
+std::size_t layoutLevels(ChainData& data, const glm::uvec2& size) {
+    constexpr auto maximum = std::numeric_limits<std::size_t>::max();
+    const auto levels      = levelCount(size);
+    auto levelSize         = size;
+    std::size_t total      = 0;
+
+    data.offsets.resize(levels);
+    data.sizes.resize(levels);
+    for (unsigned int i = 0; i < levels; i++) {
+        const auto pixels = static_cast<std::size_t>(levelSize.x);
+        if (pixels > maximum / 4 / levelSize.y) {
+            data.offsets.clear();
+            data.sizes.clear();
+            return 0;
+        }
+
+        const auto bytes = pixels * levelSize.y * 4;
+        if (bytes > maximum - total) {
+            data.offsets.clear();
+            data.sizes.clear();
+            return 0;
+        }
+
+        data.offsets[i] = total;
+        data.sizes[i]   = levelSize;
+        total += bytes;
+        levelSize = nextLevel(levelSize);
+    }
+
+    return total;
+}
+}
+
+namespace sge {
+MipChain::MipChain() : m_data(nullptr) {
+    try {
+        m_data = new ChainData;
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+MipChain::~MipChain() {
+    delete static_cast<ChainData*>(m_data);
+}
+
+bool MipChain::generate(const unsigned char* pixels,
+                        const glm::uvec2& size,
+                        const Filter filter,
+                        const bool srgb) {
+    auto* data = static_cast<ChainData*>(m_data);
+
+    data->pixels.clear();
+    data->offsets.clear();
+    data->sizes.clear();
+    if (pixels == nullptr || size.x == 0 || size.y == 0) {
+        return false;
+    }
+
+    try {
+        const auto total = layoutLevels(*data, size);
+        if (total == 0) {
+            return false;
+        }
+
+        data->pixels.resize(total);
+        std::memcpy(data->pixels.data(),
+                    pixels,
+                    static_cast<std::size_t>(size.x) * size.y * 4);
+
+        // Each level is filtered from the previous one, kept in linear space
+        // between levels to avoid repeated rounding
+        std::vector<float> current;
+        std::vector<float> next;
+        toFloat(pixels,
+                static_cast<std::size_t>(size.x) * size.y,
+                srgb,
+                current);
+        for (std::size_t i = 1; i < data->sizes.size(); i++) {
+            downsample(
+                filter, current, data->sizes[i - 1], next, data->sizes[i]);
+            toBytes(next, srgb, data->pixels.data() + data->offsets[i]);
+            current.swap(next);
+        }
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    return true;
+}
+
+bool MipChain::generate(const Image& image,
+                        const Filter filter,
+                        const bool srgb) {
+    return generate(image.getPixelData(), image.getSize(), filter, srgb);
+}
+
+bool MipChain::loadFromFile(const char* path) {
+    if (!Filesystem::exists(path)) {
+        return false;
+    }
+
+    const auto fileSize = Filesystem::getFileSize(path);
+    const InputFile file(path);
+    std::vector<unsigned char> buffer;
+
+    try {
+        buffer.resize(fileSize);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+    file.read(fileSize, buffer.data());
+
+    return loadFromMemory(buffer.size(), buffer.data());
+}
+
+bool MipChain::loadFromMemory(const std::size_t size, const void* data) {
+    auto* chain       = static_cast<ChainData*>(m_data);
+    const auto* bytes = static_cast<const unsigned char*>(data);
+
+    chain->pixels.clear();
+    chain->offsets.clear();
+    chain->sizes.clear();
+    if (size < fileHeaderSize ||
+        std::memcmp(bytes, fileMagic, sizeof(fileMagic)) != 0 ||
+        read32(bytes + 4) != fileVersion) {
+        return false;
+    }
+
+    const glm::uvec2 baseSize(read32(bytes + 8), read32(bytes + 12));
+    if (baseSize.x == 0 || baseSize.y == 0 ||
+        read32(bytes + 16) != levelCount(baseSize)) {
+        return false;
+    }
+
+    try {
+        const auto total = layoutLevels(*chain, baseSize);
+        if (total == 0 || size - fileHeaderSize != total) {
+            chain->offsets.clear();
+            chain->sizes.clear();
+            return false;
+        }
+
+        chain->pixels.assign(bytes + fileHeaderSize, bytes + size);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    return true;
+}
+
+bool MipChain::saveToFile(const char* path) const {
+    const auto* data = static_cast<ChainData*>(m_data);
+
+    if (data->sizes.empty()) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file.write(fileMagic, sizeof(fileMagic));
+    write32(file, fileVersion);
+    write32(file, data->sizes[0].x);
+    write32(file, data->sizes[0].y);
+    write32(file, static_cast<std::uint32_t>(data->sizes.size()));
+    file.write(reinterpret_cast<const char*>(data->pixels.data()),
+               data->pixels.size());
+
+    return file.good();
+}
+
+unsigned int MipChain::getLevelCount() const {
+    return static_cast<unsigned int>(
+        static_cast<ChainData*>(m_data)->sizes.size());
+}
+
+glm::uvec2 MipChain::getLevelSize(const unsigned int level) const {
+    return static_cast<ChainData*>(m_data)->sizes[level];
+}
+
+const unsigned char* MipChain::getLevelPixels(const unsigned int level) const {
+    const auto* data = static_cast<ChainData*>(m_data);
+
+    return data->pixels.data() + data->offsets[level];
+}
+}
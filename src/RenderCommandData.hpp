@@ -0,0 +1,46 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_RENDERCOMMANDDATA_HPP
+#define SGE_RENDERCOMMANDDATA_HPP
+
+#include <SGE/Vertex.hpp>
+#include <vector>
+
+namespace sge {
+class Shader;
+class Texture;
+
+/**
+ * \brief Recorded draws of a command list
+ *
+ *
+ * Vertices are stored transformed, four per quad. Each run covers
+ * consecutive quads drawn with the same state.
+ */
+struct RenderCommandData {
+    struct Run {
+        Shader* shader;
+        Texture* texture;
+        std::size_t firstQuad;
+        std::size_t quads;
+        unsigned char layer;
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<Run> runs;
+};
+}
+
+#endif//SGE_RENDERCOMMANDDATA_HPP
@@ -0,0 +1,136 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/RenderCommandList.hpp>
+#include <SGE/Application.hpp>
+#include "RenderCommandData.hpp"
+#include "VertexTransform.hpp"
+
+namespace sge {
+using namespace batching;
+
+RenderCommandList::RenderCommandList() : m_data(nullptr) {
+    try {
+        m_data = new RenderCommandData;
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+RenderCommandList::RenderCommandList(RenderCommandList&& other) noexcept
+    : m_data(other.m_data) {
+    other.m_data = nullptr;
+}
+
+RenderCommandList::~RenderCommandList() {
+    delete static_cast<RenderCommandData*>(m_data);
+}
+
+RenderCommandList&
+RenderCommandList::operator=(RenderCommandList&& other) noexcept {
+    if (this != &other) {
+        delete static_cast<RenderCommandData*>(m_data);
+        m_data       = other.m_data;
+        other.m_data = nullptr;
+    }
+
+    return *this;
+}
+
+void RenderCommandList::clear() {
+    auto* data = static_cast<RenderCommandData*>(m_data);
+
+    data->vertices.clear();
+    data->runs.clear();
+}
+
+void RenderCommandList::drawTriangle(const Vertex* vertices,
+                                     const RenderState& renderState) {
+    const auto transform = loadMatrix(renderState.transform);
+    auto* quad           = append(renderState, 1);
+
+    storeVertex(quad[0], vertices[0], transform, 0.0f);
+    storeVertex(quad[1], vertices[1], transform, 0.0f);
+    storeVertex(quad[2], vertices[2], transform, 0.0f);
+    quad[3] = quad[2];
+}
+
+void RenderCommandList::drawQuad(const Vertex* vertices,
+                                 const RenderState& renderState) {
+    storeQuad(append(renderState, 1),
+              vertices,
+              loadMatrix(renderState.transform),
+              0.0f);
+}
+
+void RenderCommandList::drawQuads(const Vertex* vertices,
+                                  const glm::mat4* transforms,
+                                  const std::size_t count,
+                                  const RenderState& renderState) {
+    if (count == 0) {
+        return;
+    }
+
+    const auto transform = loadMatrix(renderState.transform);
+    auto* quads          = append(renderState, count);
+
+    if (transforms == nullptr) {
+        for (std::size_t i = 0; i < count; i++) {
+            storeQuad(quads + i * 4, vertices + i * 4, transform, 0.0f);
+        }
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            storeQuad(quads + i * 4,
+                      vertices + i * 4,
+                      multiply(transform, transforms[i]),
+                      0.0f);
+        }
+    }
+}
+
+std::size_t RenderCommandList::getQuadCount() const {
+    return static_cast<RenderCommandData*>(m_data)->vertices.size() / 4;
+}
+
+Vertex* RenderCommandList::append(const RenderState& renderState,
+                                  const std::size_t quads) {
+    auto* data        = static_cast<RenderCommandData*>(m_data);
+    const auto vertex = data->vertices.size();
+
+    if (quads == 0) {
+        return nullptr;
+    }
+
+    try {
+        data->vertices.resize(vertex + quads * 4);
+
+        if (!data->runs.empty() &&
+            data->runs.back().shader == renderState.shader &&
+            data->runs.back().texture == renderState.texture &&
+            data->runs.back().layer == renderState.layer) {
+            data->runs.back().quads += quads;
+        } else {
+            data->runs.push_back({renderState.shader,
+                                  renderState.texture,
+                                  vertex / 4,
+                                  quads,
+                                  renderState.layer});
+        }
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    return data->vertices.data() + vertex;
+}
+}
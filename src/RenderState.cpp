@@ -18,14 +18,14 @@ namespace sge {
 RenderState RenderState::defaultState = RenderState(glm::mat4(1.0f));
 
 RenderState::RenderState(Shader* shader)
-    : shader(shader), transform(1.0f), texture(nullptr) {
+    : shader(shader), transform(1.0f), texture(nullptr), layer(0) {
 }
 
 RenderState::RenderState(const glm::mat4& transform)
-    : shader(nullptr), transform(transform), texture(nullptr) {
+    : shader(nullptr), transform(transform), texture(nullptr), layer(0) {
 }
 
 RenderState::RenderState(Texture* texture)
-    : shader(nullptr), transform(1.0f), texture(texture) {
+    : shader(nullptr), transform(1.0f), texture(texture), layer(0) {
 }
 }
@@ -15,13 +15,150 @@
 #include <SGE/RenderTarget.hpp>
 #include <SGE/Drawable.hpp>
 #include <SGE/Texture.hpp>
+#include <SGE/StaticBatch.hpp>
 #include <SGE/Application.hpp>
+#include <SGE/VertexFormat.hpp>
+#include "BindlessTexture.hpp"
+#include "VertexTransform.hpp"
+#include "RenderCommandData.hpp"
+#include "StaticBatchData.hpp"
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 #include <glad.h>
 
 namespace {
-constexpr std::size_t batchVerticesNum = 1000;
+using namespace sge::batching;
+
+constexpr std::size_t minBatchVertices = 64;
+constexpr std::size_t maxBatchVertices = 1 << 20;
+constexpr unsigned int growthFrames    = 3;
+constexpr GLuint64 fenceTimeout        = 1000000;
 unsigned int maxTextures               = 0;
+
+std::size_t clampBatchCapacity(const std::size_t capacity) {
+    if (capacity < minBatchVertices) {
+        return minBatchVertices;
+    }
+    if (capacity > maxBatchVertices) {
+        return maxBatchVertices;
+    }
+
+    return capacity & ~static_cast<std::size_t>(3);
+}
+
+constexpr unsigned int maxBindlessTextures = sge::bindless::maxTextures;
+constexpr unsigned int textureSlotsSize    = 2048;
+constexpr unsigned int handlesBinding      = sge::bindless::handlesBinding;
+
+struct BatchSegment {
+    GLsync fence;
+    sge::RenderTarget::FenceStats stats;
+};
+
+// Open-addressed texture to unit map, cleared in O(1) by bumping the
+// generation. Entries from older generations count as empty.
+struct TextureSlots {
+    struct Entry {
+        const sge::Texture* texture;
+        unsigned int unit;
+        unsigned int generation;
+    };
+
+    Entry table[textureSlotsSize];
+    sge::Texture* units[maxBindlessTextures];
+    unsigned int generation;
+};
+
+struct TextureUnits {
+    constexpr TextureUnits() : units() {
+        for (int i = 0; i < 32; i++) {
+            units[i] = i;
+        }
+    }
+
+    int units[32];
+};
+
+constexpr TextureUnits textureUnits;
+
+// Deferred draw, its four vertices are already transformed
+struct Command {
+    sge::Shader* shader;
+    sge::Texture* texture;
+    std::uint32_t vertex;
+    unsigned char layer;
+};
+
+struct SortEntry {
+    std::uint64_t key;
+    std::uint32_t index;
+};
+
+struct DeferredQueue {
+    std::vector<Command> commands;
+    std::vector<sge::Vertex> vertices;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    std::uint64_t orderedLayers[4];
+};
+
+inline bool isOrdered(const DeferredQueue& queue, const unsigned char layer) {
+    return (queue.orderedLayers[layer >> 6] >> (layer & 63) & 1) != 0;
+}
+
+// Maps a float to 24 bits that sort in the same order
+inline std::uint32_t sortableDepth(const float depth) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    bits = (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+
+    return bits >> 8;
+}
+
+// LSD radix sort by key, one byte per pass. Passes over bytes that are the
+// same for every key are skipped, so short keys sort in few passes.
+void radixSort(std::vector<SortEntry>& entries,
+               std::vector<SortEntry>& scratch) {
+    std::size_t counts[8][256] = {};
+
+    for (const auto& entry : entries) {
+        for (int pass = 0; pass < 8; pass++) {
+            counts[pass][(entry.key >> (pass * 8)) & 0xff]++;
+        }
+    }
+
+    for (int pass = 0; pass < 8; pass++) {
+        auto& count      = counts[pass];
+        const auto shift = pass * 8;
+
+        if (count[(entries[0].key >> shift) & 0xff] == entries.size()) {
+            continue;
+        }
+
+        std::size_t offset = 0;
+        for (auto& c : count) {
+            const auto n = c;
+            c            = offset;
+            offset += n;
+        }
+
+        for (const auto& entry : entries) {
+            scratch[count[(entry.key >> shift) & 0xff]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+inline unsigned int hashTexture(const sge::Texture* texture) {
+    const auto key = reinterpret_cast<std::uintptr_t>(texture) >> 4;
+
+    return static_cast<unsigned int>(key * 2654435761u) &
+           (textureSlotsSize - 1);
+}
 }
 
 namespace sge {
@@ -29,39 +166,81 @@ const CameraOrtho RenderTarget::defaultCamera = CameraOrtho();
 
 RenderTarget::RenderTarget(const ContextSettings& contextSettings)
     : m_camera(&defaultCamera), m_context(contextSettings), m_vertexCount(0),
-      m_indicesCount(0), m_indices(nullptr), m_verticesBatch(nullptr),
-      m_currentShader(nullptr), m_sync(nullptr), m_usedTextures(nullptr),
-      m_usedTextureUnits(0) {
-    glEnable(GL_DEPTH_TEST);
+      m_verticesBatch(nullptr), m_currentShader(nullptr),
+      m_batchCapacity(clampBatchCapacity(contextSettings.batchCapacity)),
+      m_adaptiveBatching(contextSettings.adaptiveBatching),
+      m_overflowed(false), m_overflowFrames(0), m_flushCount(0),
+      m_lastFlushCount(0), m_culling(false), m_culledCount(0),
+      m_lastCulledCount(0), m_segmentCount(contextSettings.batchSegments),
+      m_segment(0), m_segments(nullptr), m_usedTextures(nullptr),
+      m_usedTextureUnits(0), m_whiteTexture(0), m_whiteHandle(0),
+      m_bindless(false), m_batchBindless(false), m_handles(nullptr),
+      m_deferred(false), m_deferredQueue(nullptr) {
+    m_context.setDepthTest(true);
+    if (m_segmentCount == 0) {
+        m_segmentCount = 1;
+    }
     setBuffers();
     try {
-        m_usedTextures = new std::vector<Texture*>;
+        m_segments =
+            new std::vector<BatchSegment>(m_segmentCount, {nullptr, {0, 0, 0}});
+        m_usedTextures  = new TextureSlots{{}, {}, 1};
+        m_deferredQueue = new DeferredQueue{{}, {}, {}, {}, {0, 0, 0, 0}};
     } catch (...) {
         Application::crashApplication("Bad alloc");
     }
-    auto* ut = reinterpret_cast<std::vector<Texture*>*>(m_usedTextures);
-    ut->reserve(maxTextures);
+    setWhiteTexture();
+    setHandleBuffer();
 }
 
 RenderTarget::RenderTarget(const Window& win,
                            const ContextSettings& contextSettings)
     : m_camera(&defaultCamera), m_context(win, contextSettings),
-      m_vertexCount(0), m_indicesCount(0), m_indices(nullptr),
-      m_verticesBatch(nullptr), m_currentShader(nullptr), m_sync(nullptr),
-      m_usedTextures(nullptr), m_usedTextureUnits(0) {
-    glEnable(GL_DEPTH_TEST);
+      m_vertexCount(0), m_verticesBatch(nullptr), m_currentShader(nullptr),
+      m_batchCapacity(clampBatchCapacity(contextSettings.batchCapacity)),
+      m_adaptiveBatching(contextSettings.adaptiveBatching),
+      m_overflowed(false), m_overflowFrames(0), m_flushCount(0),
+      m_lastFlushCount(0), m_culling(false), m_culledCount(0),
+      m_lastCulledCount(0), m_segmentCount(contextSettings.batchSegments),
+      m_segment(0), m_segments(nullptr), m_usedTextures(nullptr),
+      m_usedTextureUnits(0), m_whiteTexture(0), m_whiteHandle(0),
+      m_bindless(false), m_batchBindless(false), m_handles(nullptr),
+      m_deferred(false), m_deferredQueue(nullptr) {
+    m_context.setDepthTest(true);
+    if (m_segmentCount == 0) {
+        m_segmentCount = 1;
+    }
     setBuffers();
     try {
-        m_usedTextures = new std::vector<Texture*>;
+        m_segments =
+            new std::vector<BatchSegment>(m_segmentCount, {nullptr, {0, 0, 0}});
+        m_usedTextures  = new TextureSlots{{}, {}, 1};
+        m_deferredQueue = new DeferredQueue{{}, {}, {}, {}, {0, 0, 0, 0}};
     } catch (...) {
         Application::crashApplication("Bad alloc");
     }
-    auto* ut = reinterpret_cast<std::vector<Texture*>*>(m_usedTextures);
-    ut->reserve(maxTextures);
+    setWhiteTexture();
+    setHandleBuffer();
 }
 
 RenderTarget::~RenderTarget() {
-    auto* ut = reinterpret_cast<std::vector<Texture*>*>(m_usedTextures);
+    auto* ut = reinterpret_cast<TextureSlots*>(m_usedTextures);
+    auto* sg = reinterpret_cast<std::vector<BatchSegment>*>(m_segments);
+
+    for (auto& segment : *sg) {
+        if (segment.fence != nullptr) {
+            glDeleteSync(segment.fence);
+        }
+    }
+
+    if (m_whiteHandle != 0) {
+        bindless::makeNonResident(m_whiteHandle);
+    }
+    glDeleteTextures(1, &m_whiteTexture);
+    Context::objectDeleted();
+
+    delete reinterpret_cast<DeferredQueue*>(m_deferredQueue);
+    delete sg;
     delete ut;
 }
 
@@ -137,283 +316,525 @@ void RenderTarget::draw(const Drawable& drawable,
 
 void RenderTarget::drawTriangle(const Vertex* vertices,
                                 const RenderState& renderState) {
+    if (m_culling && isCulled(vertices, 3, renderState)) {
+        return;
+    }
+
+    if (m_deferred) {
+        const auto transform = loadMatrix(renderState.transform);
+        auto* command        = pushCommand(
+            renderState.shader, renderState.texture, renderState.layer);
+
+        storeVertex(command[0], vertices[0], transform, 0.0f);
+        storeVertex(command[1], vertices[1], transform, 0.0f);
+        storeVertex(command[2], vertices[2], transform, 0.0f);
+        command[3] = command[2];
+        return;
+    }
+
     m_context.setCurrent(true);
-    auto* ut = reinterpret_cast<std::vector<Texture*>*>(m_usedTextures);
 
-    if (m_currentShader == nullptr) {
-        m_currentShader = renderState.shader;
+    const auto textureUnit = static_cast<float>(
+        prepareBatch(renderState.shader, renderState.texture));
+    const auto transform   = loadMatrix(renderState.transform);
+    auto* batch = m_verticesBatch + m_segment * m_batchCapacity + m_vertexCount;
+
+    storeVertex(batch[0], vertices[0], transform, textureUnit);
+    storeVertex(batch[1], vertices[1], transform, textureUnit);
+    storeVertex(batch[2], vertices[2], transform, textureUnit);
+    // Triangles take a quad slot, the repeated vertex makes the second
+    // triangle of the quad degenerate
+    batch[3] = batch[2];
+
+    m_vertexCount += 4;
+}
+
+void RenderTarget::drawQuad(const Vertex* vertices,
+                            const RenderState& renderState) {
+    if (m_culling && isCulled(vertices, 4, renderState)) {
+        return;
     }
 
-    if (m_vertexCount + 2 >= batchVerticesNum) {
-        flushRenderQueue();
+    if (m_deferred) {
+        auto* command = pushCommand(
+            renderState.shader, renderState.texture, renderState.layer);
+
+        storeQuad(command, vertices, loadMatrix(renderState.transform), 0.0f);
+        return;
     }
 
-    if (m_indicesCount + 2 >= batchVerticesNum) {
-        flushRenderQueue();
+    m_context.setCurrent(true);
+
+    const auto textureUnit = static_cast<float>(
+        prepareBatch(renderState.shader, renderState.texture));
+    const auto transform   = loadMatrix(renderState.transform);
+    auto* batch = m_verticesBatch + m_segment * m_batchCapacity + m_vertexCount;
+
+    storeQuad(batch, vertices, transform, textureUnit);
+
+    m_vertexCount += 4;
+}
+
+void RenderTarget::drawQuads(const Vertex* vertices,
+                             const glm::mat4* transforms,
+                             const std::size_t count,
+                             const RenderState& renderState) {
+    const auto transform = loadMatrix(renderState.transform);
+    std::size_t quad     = 0;
+
+    if (m_culling || m_deferred) {
+        const auto clip =
+            multiply(loadMatrix(getCamera()->getTransform()),
+                     renderState.transform);
+        const auto splatClip = splatMatrix(clip);
+
+        if (!m_deferred) {
+            m_context.setCurrent(true);
+        }
+
+        // Quads are culled four at a time, quads with their own transform
+        // and the last few are tested one by one
+        for (; quad < count; quad += 4) {
+            const auto quads = std::min<std::size_t>(count - quad, 4);
+            unsigned int culled = 0;
+
+            if (m_culling && transforms == nullptr && quads == 4) {
+                culled = outsideQuads(splatClip, vertices + quad * 4);
+            } else if (m_culling) {
+                for (std::size_t i = 0; i < quads; i++) {
+                    const auto outside = isOutside(
+                        transforms == nullptr
+                            ? clip
+                            : multiply(clip, transforms[quad + i]),
+                        vertices + (quad + i) * 4,
+                        4);
+                    culled |= outside ? 1u << i : 0;
+                }
+            }
+
+            for (std::size_t i = 0; i < quads; i++) {
+                if ((culled >> i & 1) != 0) {
+                    m_culledCount++;
+                    continue;
+                }
+
+                const auto quadTransform =
+                    transforms == nullptr
+                        ? transform
+                        : multiply(transform, transforms[quad + i]);
+
+                if (m_deferred) {
+                    storeQuad(pushCommand(renderState.shader,
+                                          renderState.texture,
+                                          renderState.layer),
+                              vertices + (quad + i) * 4,
+                              quadTransform,
+                              0.0f);
+                    continue;
+                }
+
+                const auto textureUnit = static_cast<float>(
+                    prepareBatch(renderState.shader, renderState.texture));
+                auto* batch = m_verticesBatch +
+                              m_segment * m_batchCapacity + m_vertexCount;
+
+                storeQuad(batch,
+                          vertices + (quad + i) * 4,
+                          quadTransform,
+                          textureUnit);
+                m_vertexCount += 4;
+            }
+        }
+        return;
     }
 
-    unsigned int textureUnit = 0;
-    bool newTexture          = true;
-    for (unsigned int i = 0; i < ut->size(); i++) {
-        try {
-            if (ut->at(i) == renderState.texture || ut->at(i) == nullptr) {
-                newTexture  = false;
-                textureUnit = i;
-                break;
+    m_context.setCurrent(true);
+
+    while (quad < count) {
+        const auto textureUnit = static_cast<float>(
+            prepareBatch(renderState.shader, renderState.texture));
+        const auto free        = (m_batchCapacity - m_vertexCount) / 4;
+        const auto quads       = std::min(count - quad, free);
+        auto* batch =
+            m_verticesBatch + m_segment * m_batchCapacity + m_vertexCount;
+
+        if (transforms == nullptr) {
+            for (std::size_t i = 0; i < quads; i++) {
+                storeQuad(batch + i * 4,
+                          vertices + (quad + i) * 4,
+                          transform,
+                          textureUnit);
+            }
+        } else {
+            for (std::size_t i = 0; i < quads; i++) {
+                storeQuad(batch + i * 4,
+                          vertices + (quad + i) * 4,
+                          multiply(transform, transforms[quad + i]),
+                          textureUnit);
             }
-        } catch (...) {
-            Application::crashApplication("Failed to access vector");
         }
+
+        m_vertexCount += quads * 4;
+        quad += quads;
     }
+}
 
-    if (newTexture && m_usedTextureUnits + 1 >= maxTextures) {
-        flushRenderQueue();
+void RenderTarget::drawInstancedQuads(const VAO& vao,
+                                      const std::size_t first,
+                                      const std::size_t count,
+                                      const RenderState& renderState) {
+    assert(renderState.shader != nullptr);
+    if (count == 0) {
+        return;
     }
 
-    if (renderState.shader != m_currentShader) {
-        flushRenderQueue();
-        m_currentShader = renderState.shader;
+    m_context.setCurrent(true);
+    flushRenderQueue();
+
+    const auto view = getViewport(*getCamera());
+    const auto top  = getPhysicalSize().y - (view.top + view.height);
+    auto* shader    = renderState.shader;
+
+    m_context.setViewport(view.left, top, view.width, view.height);
+    vao.bind();
+    shader->use();
+    if (shader->m_transform.location != -1) {
+        shader->setUniform(shader->m_transform,
+                           getCamera()->getTransform() *
+                               renderState.transform);
+    }
+    if (shader->m_textures.location != -1) {
+        shader->setUniformArray(shader->m_textures, textureUnits.units, 1);
     }
 
-    if (newTexture) {
-        try {
-            ut->push_back(renderState.texture);
-        } catch (...) {
-            Application::crashApplication("Cannot push back to vector");
-        }
-        textureUnit = m_usedTextureUnits;
-        m_usedTextureUnits++;
+    if (renderState.texture != nullptr) {
+        renderState.texture->bind(0);
+    } else {
+        m_context.bindTexture(0, m_whiteTexture);
     }
 
-    if (m_sync != nullptr) {
-        GLenum waitReturn = GL_UNSIGNALED;
-        while (waitReturn != GL_ALREADY_SIGNALED &&
-               waitReturn != GL_CONDITION_SATISFIED) {
-            waitReturn = glClientWaitSync(static_cast<GLsync>(m_sync),
-                                          GL_SYNC_FLUSH_COMMANDS_BIT,
-                                          1);
-        }
-        glDeleteSync(static_cast<GLsync>(m_sync));
-        m_sync = nullptr;
-    }
-
-    m_verticesBatch[m_vertexCount].pos =
-        renderState.transform * glm::vec4(vertices[0].pos, 1.0f);
-    m_verticesBatch[m_vertexCount].tint    = vertices[0].tint;
-    m_verticesBatch[m_vertexCount].texPos  = vertices[0].texPos;
-    m_verticesBatch[m_vertexCount].texUnit = textureUnit;
-    m_verticesBatch[m_vertexCount + 1].pos =
-        renderState.transform * glm::vec4(vertices[1].pos, 1.0f);
-    m_verticesBatch[m_vertexCount + 1].tint    = vertices[1].tint;
-    m_verticesBatch[m_vertexCount + 1].texPos  = vertices[1].texPos;
-    m_verticesBatch[m_vertexCount + 1].texUnit = textureUnit;
-    m_verticesBatch[m_vertexCount + 2].pos =
-        renderState.transform * glm::vec4(vertices[2].pos, 1.0f);
-    m_verticesBatch[m_vertexCount + 2].tint    = vertices[2].tint;
-    m_verticesBatch[m_vertexCount + 2].texPos  = vertices[2].texPos;
-    m_verticesBatch[m_vertexCount + 2].texUnit = textureUnit;
-    m_indices[m_indicesCount]                  = m_vertexCount;
-    m_indices[m_indicesCount + 1]              = m_vertexCount + 1;
-    m_indices[m_indicesCount + 2]              = m_vertexCount + 2;
-
-    m_defaultVBO.flushChanges(sizeof(Vertex) * m_vertexCount,
-                              sizeof(Vertex) * 3);
-
-    m_defaultEBO.flushChanges(sizeof(unsigned int) * m_vertexCount,
-                              sizeof(unsigned int) * 3);
-
-    m_vertexCount += 3;
-    m_indicesCount += 3;
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES,
+                                        6,
+                                        GL_UNSIGNED_INT,
+                                        nullptr,
+                                        static_cast<GLsizei>(count),
+                                        static_cast<GLuint>(first));
+    m_flushCount++;
 }
 
-void RenderTarget::drawQuad(const Vertex* vertices,
-                            const RenderState& renderState) {
+void RenderTarget::drawStatic(const StaticBatch& batch,
+                              const RenderState& renderState) {
+    auto* data = static_cast<StaticBatchData*>(batch.m_data);
+    if (data->groups.empty()) {
+        return;
+    }
+
     m_context.setCurrent(true);
-    auto* ut = reinterpret_cast<std::vector<Texture*>*>(m_usedTextures);
+    flushRenderQueue();
 
-    if (m_currentShader == nullptr) {
-        m_currentShader = renderState.shader;
-    }
+    const auto view      = getViewport(*getCamera());
+    const auto top       = getPhysicalSize().y - (view.top + view.height);
+    const auto transform = getCamera()->getTransform() * renderState.transform;
 
-    if (m_vertexCount + 3 >= batchVerticesNum) {
-        flushRenderQueue();
-    }
+    m_context.setViewport(view.left, top, view.width, view.height);
+    data->vertexArray.bind();
+    data->commandBuffer.bindDrawIndirect();
 
-    if (m_indicesCount + 5 >= batchVerticesNum) {
-        flushRenderQueue();
+    for (const auto& group : data->groups) {
+        auto* shader        = group.shader;
+        const auto bindless =
+            m_bindless && shader != nullptr && shader->m_textureHandles;
+
+        if (shader != nullptr) {
+            shader->use();
+            if (shader->m_transform.location != -1) {
+                shader->setUniform(shader->m_transform, transform);
+            }
+
+            if (bindless) {
+                waitForSegment();
+            }
+            bindTextures(shader,
+                         group.textures.data(),
+                         static_cast<unsigned int>(group.textures.size()),
+                         bindless);
+        }
+
+        glMultiDrawElementsIndirect(
+            GL_TRIANGLES,
+            GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(
+                sizeof(StaticBatchData::DrawCommand) * group.firstCommand),
+            static_cast<GLsizei>(group.commands),
+            0);
+        m_flushCount++;
+
+        // Handles were written to the current segment, it has to be fenced
+        // like a flushed batch
+        if (bindless) {
+            fenceSegment();
+        }
     }
+}
+
+void RenderTarget::submit(const RenderCommandList& list) {
+    submit(&list, 1);
+}
+
+void RenderTarget::submit(const RenderCommandList* lists,
+                          const std::size_t count) {
+    // Recorded vertices are already transformed, so culling only applies the
+    // camera
+    const auto clip      = loadMatrix(getCamera()->getTransform());
+    const auto splatClip = splatMatrix(clip);
+
+    for (std::size_t l = 0; l < count; l++) {
+        const auto* data = static_cast<RenderCommandData*>(lists[l].m_data);
+
+        for (const auto& run : data->runs) {
+            if (run.quads == 0) {
+                continue;
+            }
+
+            const auto* source = data->vertices.data() + run.firstQuad * 4;
+
+            const auto emit = [&](const std::size_t first,
+                                  const std::size_t quads) {
+                if (m_deferred) {
+                    for (std::size_t i = first; i < first + quads; i++) {
+                        copyVertices(
+                            pushCommand(run.shader, run.texture, run.layer),
+                            source + i * 4,
+                            4,
+                            0.0f);
+                    }
+                    return;
+                }
 
-    unsigned int textureUnit = 0;
-    bool newTexture          = true;
-    for (unsigned int i = 0; i < ut->size(); i++) {
-        try {
-            if (ut->at(i) == renderState.texture || ut->at(i) == nullptr) {
-                newTexture  = false;
-                textureUnit = i;
-                break;
+                m_context.setCurrent(true);
+                std::size_t quad = first;
+                while (quad < first + quads) {
+                    const auto textureUnit = static_cast<float>(
+                        prepareBatch(run.shader, run.texture));
+                    const auto free   = (m_batchCapacity - m_vertexCount) / 4;
+                    const auto copied = std::min(first + quads - quad, free);
+                    auto* batch = m_verticesBatch +
+                                  m_segment * m_batchCapacity + m_vertexCount;
+
+                    copyVertices(
+                        batch, source + quad * 4, copied * 4, textureUnit);
+                    m_vertexCount += copied * 4;
+                    quad += copied;
+                }
+            };
+
+            if (!m_culling) {
+                emit(0, run.quads);
+                continue;
+            }
+
+            // Quads are culled four at a time, and the visible ones are
+            // copied in spans between the culled ones
+            std::size_t first = 0;
+            for (std::size_t quad = 0; quad < run.quads; quad += 4) {
+                const auto quads = std::min<std::size_t>(run.quads - quad, 4);
+                unsigned int culled = 0;
+
+                if (quads == 4) {
+                    culled = outsideQuads(splatClip, source + quad * 4);
+                } else {
+                    for (std::size_t i = 0; i < quads; i++) {
+                        culled |= isOutside(clip, source + (quad + i) * 4, 4)
+                                      ? 1u << i
+                                      : 0;
+                    }
+                }
+
+                for (std::size_t i = 0; i < quads; i++) {
+                    if ((culled >> i & 1) != 0) {
+                        emit(first, quad + i - first);
+                        first = quad + i + 1;
+                        m_culledCount++;
+                    }
+                }
             }
-        } catch (...) {
-            Application::crashApplication("Failed to access vector");
+            emit(first, run.quads - first);
         }
     }
+}
 
-    if (newTexture && m_usedTextureUnits + 1 >= maxTextures) {
-        flushRenderQueue();
+void RenderTarget::flushRenderQueue() {
+    m_context.setCurrent(true);
+
+    if (m_deferred) {
+        submitCommands();
     }
 
-    if (renderState.shader != m_currentShader) {
+    flushBatch();
+}
+
+void RenderTarget::setDeferred(const bool deferred) {
+    if (m_deferred && !deferred) {
         flushRenderQueue();
-        m_currentShader = renderState.shader;
     }
 
-    if (newTexture) {
-        try {
-            ut->push_back(renderState.texture);
-        } catch (...) {
-            Application::crashApplication("Cannot push back to vector");
-        }
-        textureUnit = m_usedTextureUnits;
-        m_usedTextureUnits++;
+    m_deferred = deferred;
+}
+
+bool RenderTarget::isDeferred() const {
+    return m_deferred;
+}
+
+void RenderTarget::setLayerOrdered(const unsigned char layer,
+                                   const bool ordered) {
+    auto* dq       = reinterpret_cast<DeferredQueue*>(m_deferredQueue);
+    const auto bit = std::uint64_t(1) << (layer & 63);
+
+    if (ordered) {
+        dq->orderedLayers[layer >> 6] |= bit;
+    } else {
+        dq->orderedLayers[layer >> 6] &= ~bit;
     }
+}
 
-    if (m_sync != nullptr) {
-        GLenum waitReturn = GL_UNSIGNALED;
-        while (waitReturn != GL_ALREADY_SIGNALED &&
-               waitReturn != GL_CONDITION_SATISFIED) {
-            waitReturn = glClientWaitSync(static_cast<GLsync>(m_sync),
-                                          GL_SYNC_FLUSH_COMMANDS_BIT,
-                                          1);
-        }
-        glDeleteSync(static_cast<GLsync>(m_sync));
-        m_sync = nullptr;
-    }
-
-    m_verticesBatch[m_vertexCount].pos =
-        renderState.transform * glm::vec4(vertices[0].pos, 1.0f);
-    m_verticesBatch[m_vertexCount].tint    = vertices[0].tint;
-    m_verticesBatch[m_vertexCount].texPos  = vertices[0].texPos;
-    m_verticesBatch[m_vertexCount].texUnit = textureUnit;
-    m_verticesBatch[m_vertexCount + 1].pos =
-        renderState.transform * glm::vec4(vertices[1].pos, 1.0f);
-    m_verticesBatch[m_vertexCount + 1].tint    = vertices[1].tint;
-    m_verticesBatch[m_vertexCount + 1].texPos  = vertices[1].texPos;
-    m_verticesBatch[m_vertexCount + 1].texUnit = textureUnit;
-    m_verticesBatch[m_vertexCount + 2].pos =
-        renderState.transform * glm::vec4(vertices[2].pos, 1.0f);
-    m_verticesBatch[m_vertexCount + 2].tint    = vertices[2].tint;
-    m_verticesBatch[m_vertexCount + 2].texPos  = vertices[2].texPos;
-    m_verticesBatch[m_vertexCount + 2].texUnit = textureUnit;
-    m_verticesBatch[m_vertexCount + 3].pos =
-        renderState.transform * glm::vec4(vertices[3].pos, 1.0f);
-    m_verticesBatch[m_vertexCount + 3].tint    = vertices[3].tint;
-    m_verticesBatch[m_vertexCount + 3].texPos  = vertices[3].texPos;
-    m_verticesBatch[m_vertexCount + 3].texUnit = textureUnit;
-    m_indices[m_indicesCount]                  = m_vertexCount;
-    m_indices[m_indicesCount + 1]              = m_vertexCount + 1;
-    m_indices[m_indicesCount + 2]              = m_vertexCount + 2;
-    m_indices[m_indicesCount + 3]              = m_vertexCount + 2;
-    m_indices[m_indicesCount + 4]              = m_vertexCount + 1;
-    m_indices[m_indicesCount + 5]              = m_vertexCount + 3;
-
-    m_defaultVBO.flushChanges(sizeof(Vertex) * m_vertexCount,
-                              sizeof(Vertex) * 4);
-
-    m_defaultEBO.flushChanges(sizeof(unsigned int) * m_vertexCount,
-                              sizeof(unsigned int) * 6);
+bool RenderTarget::isLayerOrdered(const unsigned char layer) const {
+    auto* dq = reinterpret_cast<DeferredQueue*>(m_deferredQueue);
 
-    m_vertexCount += 4;
-    m_indicesCount += 6;
+    return isOrdered(*dq, layer);
 }
 
-void RenderTarget::flushRenderQueue() {
+void RenderTarget::flushBatch() {
     if (m_vertexCount == 0) {
         return;
     }
 
-    auto* ut = reinterpret_cast<std::vector<Texture*>*>(m_usedTextures);
+    m_context.setCurrent(true);
+
+    auto* ut = reinterpret_cast<TextureSlots*>(m_usedTextures);
 
     const auto view = getViewport(*getCamera());
     const auto top  = getPhysicalSize().y - (view.top + view.height);
 
-    glViewport(view.left, top, view.width, view.height);
+    m_context.setViewport(view.left, top, view.width, view.height);
+    m_defaultVAO.bind();
 
     if (m_currentShader != nullptr) {
         m_currentShader->use();
-        if (m_currentShader->hasUniform("transform")) {
-            m_currentShader->setUniform("transform",
+        if (m_currentShader->m_transform.location != -1) {
+            m_currentShader->setUniform(m_currentShader->m_transform,
                                         getCamera()->getTransform());
         }
 
-        if (m_currentShader->hasUniform("tex[0]")) {
-            for (int i = 0; i < m_usedTextureUnits; i++) {
-                try {
-                    std::string u = "tex[" + std::to_string(i) + "]";
-                    m_currentShader->setUniform(u.c_str(), i);
-                    ut->at(i)->bind(i);
-                } catch (...) {
-                    Application::crashApplication("Failed string manipulation");
-                }
-            }
-        }
+        bindTextures(m_currentShader,
+                     ut->units,
+                     m_usedTextureUnits,
+                     m_batchBindless);
     }
 
-    glDrawElements(GL_TRIANGLES, m_indicesCount, GL_UNSIGNED_INT, 0);
+    m_defaultVBO.flushChanges(sizeof(BatchVertex) * m_segment *
+                                  m_batchCapacity,
+                              sizeof(BatchVertex) * m_vertexCount);
 
-    if (m_sync != nullptr) {
-        glDeleteSync(static_cast<GLsync>(m_sync));
-    }
+    glDrawElementsBaseVertex(GL_TRIANGLES,
+                             m_vertexCount / 4 * 6,
+                             GL_UNSIGNED_INT,
+                             nullptr,
+                             m_segment * m_batchCapacity);
+    m_flushCount++;
 
-    m_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fenceSegment();
 
     m_vertexCount      = 0;
-    m_indicesCount     = 0;
     m_usedTextureUnits = 0;
-    ut->clear();
+    ut->generation++;
+    if (ut->generation == 0) {
+        *ut = TextureSlots{{}, {}, 1};
+    }
     m_currentShader = nullptr;
 }
 
+void RenderTarget::setCulling(const bool culling) {
+    m_culling = culling;
+}
+
+bool RenderTarget::isCulling() const {
+    return m_culling;
+}
+
+unsigned int RenderTarget::getCulledCount() const {
+    return m_lastCulledCount;
+}
+
+bool RenderTarget::hasBindlessTextures() const {
+    return m_bindless;
+}
+
+unsigned int RenderTarget::getBatchSegments() const {
+    return m_segmentCount;
+}
+
+RenderTarget::FenceStats
+RenderTarget::getFenceStats(const unsigned int segment) const {
+    auto* sg = reinterpret_cast<std::vector<BatchSegment>*>(m_segments);
+
+    try {
+        return sg->at(segment).stats;
+    } catch (...) {
+        Application::crashApplication("Failed to access vector");
+    }
+}
+
+void RenderTarget::resetFenceStats() {
+    auto* sg = reinterpret_cast<std::vector<BatchSegment>*>(m_segments);
+
+    for (auto& segment : *sg) {
+        segment.stats = {0, 0, 0};
+    }
+}
+
+std::size_t RenderTarget::getBatchCapacity() const {
+    return m_batchCapacity;
+}
+
+unsigned int RenderTarget::getFlushCount() const {
+    return m_lastFlushCount;
+}
+
+void RenderTarget::endFrame() {
+    m_lastFlushCount  = m_flushCount;
+    m_flushCount      = 0;
+    m_lastCulledCount = m_culledCount;
+    m_culledCount     = 0;
+
+    if (!m_adaptiveBatching) {
+        return;
+    }
+
+    if (m_overflowed) {
+        m_overflowFrames++;
+    } else {
+        m_overflowFrames = 0;
+    }
+    m_overflowed = false;
+
+    if (m_overflowFrames >= growthFrames &&
+        m_batchCapacity < maxBatchVertices) {
+        m_overflowFrames = 0;
+        growBatch();
+    }
+}
+
 void RenderTarget::setBuffers() {
-    m_defaultVBO.allocate(sizeof(Vertex) * batchVerticesNum, VBO::WriteAccess);
-    m_defaultEBO.allocate(sizeof(unsigned int) * batchVerticesNum,
+    m_defaultVBO.allocate(sizeof(BatchVertex) * m_batchCapacity *
+                              m_segmentCount,
                           VBO::WriteAccess);
-    m_defaultVAO.bindVBO(m_defaultVBO, 0, 0, sizeof(Vertex));
-    m_defaultVAO.enableAttribute(0);
-    m_defaultVAO.enableAttribute(1);
-    m_defaultVAO.enableAttribute(2);
-    m_defaultVAO.enableAttribute(3);
-    m_defaultVAO.setAttributeFormat(0,
-                                    3,
-                                    VAO::Data::Float,
-                                    true,
-                                    offsetof(Vertex, pos));
-    m_defaultVAO.setAttributeFormat(1,
-                                    3,
-                                    VAO::Data::UnsignedByte,
-                                    true,
-                                    offsetof(Vertex, tint));
-    m_defaultVAO.setAttributeFormat(2,
-                                    2,
-                                    VAO::Data::Float,
-                                    true,
-                                    offsetof(Vertex, texPos));
-    m_defaultVAO.setAttributeFormat(3,
-                                    1,
-                                    VAO::Data::Float,
-                                    false,
-                                    offsetof(Vertex, texUnit));
-    m_defaultVAO.setAttributeBinding(0, 0);
-    m_defaultVAO.setAttributeBinding(1, 0);
-    m_defaultVAO.setAttributeBinding(2, 0);
-    m_defaultVAO.setAttributeBinding(3, 0);
-
-    m_verticesBatch =
-        static_cast<Vertex*>(m_defaultVBO.mapBuffer(0,
-                                                    m_defaultVBO.getSize(),
-                                                    VBO::WriteAccess,
-                                                    true));
-    m_indices = static_cast<unsigned int*>(
-        m_defaultEBO.mapBuffer(0,
-                               m_defaultEBO.getSize(),
+    setQuadIndices();
+    m_defaultVAO.bindVBO(m_defaultVBO, 0, 0, sizeof(BatchVertex));
+    VertexFormat<BatchVertex>::configure(m_defaultVAO, 0);
+
+    m_verticesBatch = static_cast<BatchVertex*>(
+        m_defaultVBO.mapBuffer(0,
+                               m_defaultVBO.getSize(),
                                VBO::WriteAccess,
                                true));
 
@@ -427,4 +848,283 @@ void RenderTarget::setBuffers() {
         }
     }
 }
+
+void RenderTarget::setQuadIndices() {
+    std::vector<unsigned int> indices;
+    const auto quads = m_batchCapacity / 4;
+
+    try {
+        indices.resize(quads * 6);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    for (std::size_t i = 0; i < quads; i++) {
+        const auto vertex = static_cast<unsigned int>(i * 4);
+        indices[i * 6]     = vertex;
+        indices[i * 6 + 1] = vertex + 1;
+        indices[i * 6 + 2] = vertex + 2;
+        indices[i * 6 + 3] = vertex + 2;
+        indices[i * 6 + 4] = vertex + 1;
+        indices[i * 6 + 5] = vertex + 3;
+    }
+
+    m_defaultEBO.allocate(sizeof(unsigned int) * indices.size(),
+                          VBO::NoAccess,
+                          indices.data());
+}
+
+unsigned int RenderTarget::prepareBatch(Shader* shader, Texture* texture) {
+    auto* ut = reinterpret_cast<TextureSlots*>(m_usedTextures);
+
+    if (m_currentShader == nullptr) {
+        m_currentShader = shader;
+    }
+
+    if (m_vertexCount + 4 > m_batchCapacity) {
+        m_overflowed = true;
+        flushBatch();
+    }
+
+    if (shader != m_currentShader) {
+        flushBatch();
+        m_currentShader = shader;
+    }
+
+    if (m_vertexCount == 0) {
+        m_batchBindless = m_bindless && m_currentShader != nullptr &&
+                          m_currentShader->m_textureHandles;
+    }
+
+    auto slot = hashTexture(texture);
+    while (ut->table[slot].generation == ut->generation &&
+           ut->table[slot].texture != texture) {
+        slot = (slot + 1) & (textureSlotsSize - 1);
+    }
+
+    auto* entry = &ut->table[slot];
+    if (entry->generation != ut->generation) {
+        const auto limit = m_batchBindless ? maxBindlessTextures : maxTextures;
+        if (m_usedTextureUnits >= limit) {
+            flushBatch();
+            m_currentShader = shader;
+
+            slot  = hashTexture(texture);
+            entry = &ut->table[slot];
+        }
+
+        entry->texture                = texture;
+        entry->unit                   = m_usedTextureUnits;
+        entry->generation             = ut->generation;
+        ut->units[m_usedTextureUnits] = texture;
+        m_usedTextureUnits++;
+    }
+
+    if (m_vertexCount == 0) {
+        waitForSegment();
+    }
+
+    return entry->unit;
+}
+
+Vertex* RenderTarget::pushCommand(Shader* shader,
+                                  Texture* texture,
+                                  const unsigned char layer) {
+    auto* dq          = reinterpret_cast<DeferredQueue*>(m_deferredQueue);
+    const auto vertex = static_cast<std::uint32_t>(dq->vertices.size());
+
+    try {
+        dq->commands.push_back({shader, texture, vertex, layer});
+        dq->vertices.resize(vertex + 4);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    return &dq->vertices[vertex];
+}
+
+void RenderTarget::submitCommands() {
+    auto* dq         = reinterpret_cast<DeferredQueue*>(m_deferredQueue);
+    const auto count = dq->commands.size();
+
+    if (count == 0) {
+        return;
+    }
+
+    try {
+        dq->entries.resize(count);
+        dq->scratch.resize(count);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        const auto& command = dq->commands[i];
+        auto key = static_cast<std::uint64_t>(command.layer) << 56;
+
+        if (isOrdered(*dq, command.layer)) {
+            key |= i;
+        } else {
+            const auto shader =
+                command.shader != nullptr ? command.shader->m_id : 0;
+            const auto texture =
+                command.texture != nullptr ? command.texture->m_id : 0;
+
+            key |= static_cast<std::uint64_t>(shader & 0xfff) << 44;
+            key |= static_cast<std::uint64_t>(texture & 0xfffff) << 24;
+            key |= sortableDepth(dq->vertices[command.vertex].pos.z);
+        }
+
+        dq->entries[i] = {key, static_cast<std::uint32_t>(i)};
+    }
+
+    radixSort(dq->entries, dq->scratch);
+
+    m_context.setCurrent(true);
+    for (const auto& entry : dq->entries) {
+        const auto& command    = dq->commands[entry.index];
+        const auto textureUnit = static_cast<float>(
+            prepareBatch(command.shader, command.texture));
+        auto* batch =
+            m_verticesBatch + m_segment * m_batchCapacity + m_vertexCount;
+
+        copyVertices(batch, &dq->vertices[command.vertex], 4, textureUnit);
+        m_vertexCount += 4;
+    }
+
+    dq->commands.clear();
+    dq->vertices.clear();
+}
+
+void RenderTarget::setWhiteTexture() {
+    const unsigned char white[] = {255, 255, 255, 255};
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_whiteTexture);
+    glTextureStorage2D(m_whiteTexture, 1, GL_RGBA8, 1, 1);
+    glTextureSubImage2D(m_whiteTexture,
+                        0,
+                        0,
+                        0,
+                        1,
+                        1,
+                        GL_RGBA,
+                        GL_UNSIGNED_BYTE,
+                        white);
+}
+
+void RenderTarget::setHandleBuffer() {
+    if (!bindless::isAvailable()) {
+        return;
+    }
+
+    m_bindless    = true;
+    m_whiteHandle = bindless::makeResident(m_whiteTexture);
+    m_handleBuffer.allocate(sizeof(std::uint64_t) * maxBindlessTextures *
+                                m_segmentCount,
+                            VBO::WriteAccess);
+    m_handles = static_cast<std::uint64_t*>(
+        m_handleBuffer.mapBuffer(0,
+                                 m_handleBuffer.getSize(),
+                                 VBO::WriteAccess,
+                                 true));
+}
+
+bool RenderTarget::isCulled(const Vertex* vertices,
+                            const std::size_t count,
+                            const RenderState& renderState) {
+    const auto clip = multiply(loadMatrix(getCamera()->getTransform()),
+                               renderState.transform);
+
+    if (!isOutside(clip, vertices, count)) {
+        return false;
+    }
+
+    m_culledCount++;
+    return true;
+}
+
+void RenderTarget::bindTextures(Shader* shader,
+                                Texture* const* textures,
+                                const unsigned int count,
+                                const bool bindless) {
+    if (bindless) {
+        const auto base = m_segment * maxBindlessTextures;
+        for (unsigned int i = 0; i < count; i++) {
+            m_handles[base + i] = textures[i] != nullptr
+                                      ? textures[i]->getHandle()
+                                      : m_whiteHandle;
+        }
+
+        m_handleBuffer.flushChanges(sizeof(std::uint64_t) * base,
+                                    sizeof(std::uint64_t) * count);
+        m_handleBuffer.bindShaderStorage(handlesBinding,
+                                         sizeof(std::uint64_t) * base,
+                                         sizeof(std::uint64_t) *
+                                             maxBindlessTextures);
+    } else if (shader->m_textures.location != -1) {
+        shader->setUniformArray(shader->m_textures, textureUnits.units, count);
+
+        for (unsigned int i = 0; i < count; i++) {
+            if (textures[i] != nullptr) {
+                textures[i]->bind(i);
+            } else {
+                m_context.bindTexture(i, m_whiteTexture);
+            }
+        }
+    }
+}
+
+void RenderTarget::fenceSegment() {
+    auto* sg      = reinterpret_cast<std::vector<BatchSegment>*>(m_segments);
+    auto& segment = (*sg)[m_segment];
+
+    segment.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    segment.stats.fences++;
+    m_segment = (m_segment + 1) % m_segmentCount;
+}
+
+void RenderTarget::waitForSegment() {
+    auto* sg      = reinterpret_cast<std::vector<BatchSegment>*>(m_segments);
+    auto& segment = (*sg)[m_segment];
+
+    if (segment.fence == nullptr) {
+        return;
+    }
+
+    GLenum waitReturn = glClientWaitSync(segment.fence, 0, 0);
+    if (waitReturn == GL_TIMEOUT_EXPIRED) {
+        segment.stats.stalls++;
+        do {
+            waitReturn = glClientWaitSync(segment.fence,
+                                          GL_SYNC_FLUSH_COMMANDS_BIT,
+                                          fenceTimeout);
+            if (waitReturn == GL_TIMEOUT_EXPIRED) {
+                segment.stats.timeouts++;
+            }
+        } while (waitReturn == GL_TIMEOUT_EXPIRED);
+    }
+
+    if (waitReturn == GL_WAIT_FAILED) {
+        Application::crashApplication("Failed to wait for batch fence");
+    }
+
+    glDeleteSync(segment.fence);
+    segment.fence = nullptr;
+}
+
+void RenderTarget::growBatch() {
+    m_context.setCurrent(true);
+    flushRenderQueue();
+
+    const auto current = m_segment;
+    for (m_segment = 0; m_segment < m_segmentCount; m_segment++) {
+        waitForSegment();
+    }
+    m_segment = current;
+
+    m_batchCapacity = clampBatchCapacity(m_batchCapacity * 2);
+    m_defaultVBO    = VBO();
+    m_defaultEBO    = VBO();
+    setBuffers();
+}
 }
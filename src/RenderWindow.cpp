@@ -52,5 +52,6 @@ void RenderWindow::swapBuffers() {
 
     flushRenderQueue();
     SDL_GL_SwapWindow(w);
+    endFrame();
 }
 }
@@ -0,0 +1,477 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/SceneIndex.hpp>
+#include <SGE/RenderTarget.hpp>
+#include <SGE/Transformable.hpp>
+#include <SGE/Sprite.hpp>
+#include <SGE/Camera.hpp>
+#include <SGE/Application.hpp>
+#include "ViewArea.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+// Entries covering more cells than this are kept in a list tested by every
+// query instead
+constexpr std::int64_t maxEntryCells = 64;
+
+struct Bounds {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+};
+
+struct CellRange {
+    std::int32_t minX;
+    std::int32_t minY;
+    std::int32_t maxX;
+    std::int32_t maxY;
+};
+
+struct Entry {
+    const sge::Drawable* drawable;
+    const sge::Transformable* transformable;
+    const sge::Sprite* sprite;
+    sge::RectangleFloat bounds;
+    Bounds world;
+    CellRange cells;
+    bool large;
+    bool alive;
+    bool moved;
+    std::uint32_t queryMark;
+    std::uint64_t sequence;
+};
+
+struct SceneData {
+    float cellSize;
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> freeHandles;
+    std::vector<std::uint32_t> moved;
+    std::vector<std::uint32_t> large;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells;
+    std::vector<std::uint32_t> found;
+    std::vector<const sge::Drawable*> results;
+    std::uint32_t queryMark;
+    std::uint64_t sequence;
+    std::size_t size;
+};
+
+Bounds normalize(const sge::RectangleFloat& rect) {
+    return {std::min(rect.left, rect.left + rect.width),
+            std::min(rect.top, rect.top + rect.height),
+            std::max(rect.left, rect.left + rect.width),
+            std::max(rect.top, rect.top + rect.height)};
+}
+
+// Sprites may be drawn with a pooled transform instead of their own
+const glm::mat4& getTransform(const Entry& entry) {
+    return entry.sprite != nullptr ? entry.sprite->getWorldTransform()
+                                   : entry.transformable->getTransform();
+}
+
+Bounds worldBounds(const Entry& entry) {
+    const auto model = normalize(entry.bounds);
+    if (entry.transformable == nullptr) {
+        return model;
+    }
+
+    const auto& transform = getTransform(entry);
+    const glm::vec4 corners[] = {
+        transform * glm::vec4(model.minX, model.minY, 0.0f, 1.0f),
+        transform * glm::vec4(model.maxX, model.minY, 0.0f, 1.0f),
+        transform * glm::vec4(model.minX, model.maxY, 0.0f, 1.0f),
+        transform * glm::vec4(model.maxX, model.maxY, 0.0f, 1.0f)};
+
+    Bounds world = {corners[0].x, corners[0].y, corners[0].x, corners[0].y};
+    for (const auto& corner : corners) {
+        world.minX = std::min(world.minX, corner.x);
+        world.minY = std::min(world.minY, corner.y);
+        world.maxX = std::max(world.maxX, corner.x);
+        world.maxY = std::max(world.maxY, corner.y);
+    }
+
+    return world;
+}
+
+// Sprite bounds have their top at the largest y, as sprites extend down from
+// their origin
+sge::RectangleFloat fromSpriteBounds(const sge::RectangleFloat& bounds) {
+    return sge::RectangleFloat(
+        bounds.left, bounds.top - bounds.height, bounds.width, bounds.height);
+}
+
+bool intersects(const Bounds& a, const Bounds& b) {
+    return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY &&
+           b.minY <= a.maxY;
+}
+
+CellRange cellRange(const Bounds& bounds, const float cellSize) {
+    return {static_cast<std::int32_t>(std::floor(bounds.minX / cellSize)),
+            static_cast<std::int32_t>(std::floor(bounds.minY / cellSize)),
+            static_cast<std::int32_t>(std::floor(bounds.maxX / cellSize)),
+            static_cast<std::int32_t>(std::floor(bounds.maxY / cellSize))};
+}
+
+std::int64_t cellCount(const CellRange& range) {
+    return (static_cast<std::int64_t>(range.maxX) - range.minX + 1) *
+           (static_cast<std::int64_t>(range.maxY) - range.minY + 1);
+}
+
+std::uint64_t cellKey(const std::int32_t x, const std::int32_t y) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32 |
+           static_cast<std::uint32_t>(y);
+}
+
+void eraseHandle(std::vector<std::uint32_t>& handles,
+                 const std::uint32_t handle) {
+    const auto it = std::find(handles.begin(), handles.end(), handle);
+    if (it != handles.end()) {
+        *it = handles.back();
+        handles.pop_back();
+    }
+}
+
+void link(SceneData& data, const std::uint32_t handle) {
+    auto& entry = data.entries[handle];
+
+    entry.world = worldBounds(entry);
+    entry.cells = cellRange(entry.world, data.cellSize);
+    entry.large = cellCount(entry.cells) > maxEntryCells;
+
+    try {
+        if (entry.large) {
+            data.large.push_back(handle);
+            return;
+        }
+
+        for (auto y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+            for (auto x = entry.cells.minX; x <= entry.cells.maxX; x++) {
+                data.cells[cellKey(x, y)].push_back(handle);
+            }
+        }
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+}
+
+void unlink(SceneData& data, const std::uint32_t handle) {
+    const auto& entry = data.entries[handle];
+
+    if (entry.large) {
+        eraseHandle(data.large, handle);
+        return;
+    }
+
+    for (auto y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+        for (auto x = entry.cells.minX; x <= entry.cells.maxX; x++) {
+            const auto cell = data.cells.find(cellKey(x, y));
+            if (cell == data.cells.end()) {
+                continue;
+            }
+
+            eraseHandle(cell->second, handle);
+            if (cell->second.empty()) {
+                data.cells.erase(cell);
+            }
+        }
+    }
+}
+
+// Moves an entry to the cells of its current bounds, touching the grid only
+// if the cells changed
+void relink(SceneData& data, const std::uint32_t handle) {
+    auto& entry      = data.entries[handle];
+    const auto world = worldBounds(entry);
+    const auto cells = cellRange(world, data.cellSize);
+
+    if (cells.minX == entry.cells.minX && cells.minY == entry.cells.minY &&
+        cells.maxX == entry.cells.maxX && cells.maxY == entry.cells.maxY) {
+        entry.world = world;
+        return;
+    }
+
+    unlink(data, handle);
+    link(data, handle);
+}
+
+void collect(SceneData& data,
+             const std::vector<std::uint32_t>& handles,
+             const Bounds& area) {
+    for (const auto handle : handles) {
+        auto& entry = data.entries[handle];
+        if (entry.queryMark == data.queryMark) {
+            continue;
+        }
+
+        entry.queryMark = data.queryMark;
+        if (intersects(entry.world, area)) {
+            data.found.push_back(handle);
+        }
+    }
+}
+
+std::uint32_t addEntry(SceneData& data,
+                       const sge::Drawable& drawable,
+                       const sge::Transformable* transformable,
+                       const sge::Sprite* sprite,
+                       const sge::RectangleFloat& bounds) {
+    std::uint32_t handle;
+
+    try {
+        if (data.freeHandles.empty()) {
+            handle = static_cast<std::uint32_t>(data.entries.size());
+            data.entries.emplace_back();
+        } else {
+            handle = data.freeHandles.back();
+            data.freeHandles.pop_back();
+        }
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+
+    auto& entry = data.entries[handle];
+
+    entry = {&drawable,
+             transformable,
+             sprite,
+             bounds,
+             {},
+             {},
+             false,
+             true,
+             false,
+             data.queryMark,
+             data.sequence++};
+    data.size++;
+    link(data, handle);
+
+    return handle;
+}
+
+// Only the entries marked as moved are visited. Removed entries are unmarked
+// and skipped, as are handles marked again after being reused
+void updateEntries(SceneData& data) {
+    for (const auto handle : data.moved) {
+        auto& entry = data.entries[handle];
+
+        if (entry.moved) {
+            entry.moved = false;
+            relink(data, handle);
+        }
+    }
+    data.moved.clear();
+}
+
+std::size_t queryEntries(SceneData& data, const sge::RectangleFloat& area) {
+    const auto bounds = normalize(area);
+    const auto range  = cellRange(bounds, data.cellSize);
+
+    data.queryMark++;
+    if (data.queryMark == 0) {
+        for (auto& entry : data.entries) {
+            entry.queryMark = 0;
+        }
+        data.queryMark = 1;
+    }
+
+    data.found.clear();
+    data.results.clear();
+    try {
+        // Visit the occupied cells instead of the area's cells when there
+        // are fewer of them
+        if (cellCount(range) > static_cast<std::int64_t>(data.cells.size())) {
+            for (const auto& cell : data.cells) {
+                collect(data, cell.second, bounds);
+            }
+        } else {
+            for (auto y = range.minY; y <= range.maxY; y++) {
+                for (auto x = range.minX; x <= range.maxX; x++) {
+                    const auto cell = data.cells.find(cellKey(x, y));
+                    if (cell != data.cells.end()) {
+                        collect(data, cell->second, bounds);
+                    }
+                }
+            }
+        }
+        collect(data, data.large, bounds);
+
+        // Handles are reused, so they don't follow insertion order
+        std::sort(data.found.begin(),
+                  data.found.end(),
+                  [&data](const std::uint32_t a, const std::uint32_t b) {
+                      return data.entries[a].sequence <
+                             data.entries[b].sequence;
+                  });
+        data.results.reserve(data.found.size());
+        for (const auto handle : data.found) {
+            data.results.push_back(data.entries[handle].drawable);
+        }
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+
+    return data.results.size();
+}
+}
+
+namespace sge {
+SceneIndex::SceneIndex(const float cellSize) : m_data(nullptr) {
+    try {
+        m_data = new SceneData{cellSize > 0.0f ? cellSize : 256.0f,
+                               {},
+                               {},
+                               {},
+                               {},
+                               {},
+                               {},
+                               {},
+                               0,
+                               0,
+                               0};
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+SceneIndex::~SceneIndex() {
+    delete static_cast<SceneData*>(m_data);
+}
+
+SceneIndex::Handle SceneIndex::insert(const Drawable& drawable,
+                                      const RectangleFloat& bounds) {
+    return addEntry(
+        *static_cast<SceneData*>(m_data), drawable, nullptr, nullptr, bounds);
+}
+
+SceneIndex::Handle SceneIndex::insert(const Drawable& drawable,
+                                      const Transformable& transformable,
+                                      const RectangleFloat& modelBounds) {
+    return addEntry(*static_cast<SceneData*>(m_data),
+                    drawable,
+                    &transformable,
+                    nullptr,
+                    modelBounds);
+}
+
+SceneIndex::Handle SceneIndex::insert(const Sprite& sprite,
+                                      const bool tracked) {
+    auto* data = static_cast<SceneData*>(m_data);
+
+    if (!tracked) {
+        return addEntry(*data,
+                        sprite,
+                        nullptr,
+                        nullptr,
+                        fromSpriteBounds(sprite.getWorldBounds()));
+    }
+
+    return addEntry(*data,
+                    sprite,
+                    &sprite,
+                    &sprite,
+                    fromSpriteBounds(sprite.getModelBounds()));
+}
+
+void SceneIndex::setBounds(const Handle handle, const RectangleFloat& bounds) {
+    auto* data  = static_cast<SceneData*>(m_data);
+    auto& entry = data->entries[handle];
+
+    if (!entry.alive) {
+        return;
+    }
+
+    entry.bounds = bounds;
+    relink(*data, handle);
+}
+
+void SceneIndex::markMoved(const Handle handle) {
+    auto* data  = static_cast<SceneData*>(m_data);
+    auto& entry = data->entries[handle];
+
+    if (!entry.alive || entry.moved || entry.transformable == nullptr) {
+        return;
+    }
+
+    entry.moved = true;
+    try {
+        data->moved.push_back(handle);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+void SceneIndex::remove(const Handle handle) {
+    auto* data  = static_cast<SceneData*>(m_data);
+    auto& entry = data->entries[handle];
+
+    if (!entry.alive) {
+        return;
+    }
+
+    unlink(*data, handle);
+    entry.alive = false;
+    entry.moved = false;
+    data->size--;
+    try {
+        data->freeHandles.push_back(handle);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+void SceneIndex::clear() {
+    auto* data = static_cast<SceneData*>(m_data);
+
+    data->entries.clear();
+    data->freeHandles.clear();
+    data->moved.clear();
+    data->large.clear();
+    data->cells.clear();
+    data->found.clear();
+    data->results.clear();
+    data->size = 0;
+}
+
+void SceneIndex::update() {
+    updateEntries(*static_cast<SceneData*>(m_data));
+}
+
+std::size_t SceneIndex::query(const RectangleFloat& area) {
+    return queryEntries(*static_cast<SceneData*>(m_data), area);
+}
+
+const Drawable* const* SceneIndex::getQueryResults() const {
+    return static_cast<SceneData*>(m_data)->results.data();
+}
+
+std::size_t SceneIndex::getSize() const {
+    return static_cast<SceneData*>(m_data)->size;
+}
+
+void SceneIndex::draw(RenderTarget& target, RenderState renderState) const {
+    auto* data = static_cast<SceneData*>(m_data);
+
+    updateEntries(*data);
+    const auto area  = view::getArea(target.getCamera()->getTransform());
+    const auto count = queryEntries(*data, area);
+
+    for (std::size_t i = 0; i < count; i++) {
+        target.draw(*data->results[i], renderState);
+    }
+}
+}
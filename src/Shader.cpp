@@ -23,7 +23,9 @@
 #include <glad.h>
 
 namespace sge {
-Shader::Shader() : m_uniforms(nullptr) {
+Shader::Shader()
+    : m_uniforms(nullptr), m_transform({-1}), m_textures({-1}),
+      m_textureHandles(false) {
     assert(Context::getCurrentContext());
     try {
         m_uniforms = new std::unordered_map<std::string, int>;
@@ -33,13 +35,20 @@ Shader::Shader() : m_uniforms(nullptr) {
     m_id = glCreateProgram();
 }
 
-Shader::Shader(Shader&& other) noexcept : m_id(other.m_id) {
-    other.m_id = 0;
+Shader::Shader(Shader&& other) noexcept
+    : m_id(other.m_id), m_uniforms(other.m_uniforms),
+      m_transform(other.m_transform), m_textures(other.m_textures),
+      m_textureHandles(other.m_textureHandles) {
+    other.m_id       = 0;
+    other.m_uniforms = nullptr;
 }
 
 Shader::~Shader() {
     assert(Context::getCurrentContext());
-    glDeleteProgram(m_id);
+    if (m_id != 0) {
+        glDeleteProgram(m_id);
+        Context::objectDeleted();
+    }
 
     auto* uf =
         reinterpret_cast<std::unordered_map<std::string, int>*>(m_uniforms);
@@ -47,8 +56,23 @@ Shader::~Shader() {
 }
 
 Shader& Shader::operator=(Shader&& other) noexcept {
-    m_id       = other.m_id;
-    other.m_id = 0;
+    if (this == &other) {
+        return *this;
+    }
+
+    if (m_id != 0) {
+        glDeleteProgram(m_id);
+        Context::objectDeleted();
+    }
+    delete reinterpret_cast<std::unordered_map<std::string, int>*>(m_uniforms);
+
+    m_id             = other.m_id;
+    m_uniforms       = other.m_uniforms;
+    m_transform      = other.m_transform;
+    m_textures       = other.m_textures;
+    m_textureHandles = other.m_textureHandles;
+    other.m_id       = 0;
+    other.m_uniforms = nullptr;
 
     return *this;
 }
@@ -188,11 +212,23 @@ bool Shader::link() {
         delete[] nameBuffer;
     }
 
+    m_transform      = getUniformHandle("transform");
+    m_textures       = getUniformHandle("tex[0]");
+    m_textureHandles = hasStorageBlock("TextureHandles");
+
     return true;
 }
 
 void Shader::use() const {
-    glUseProgram(m_id);
+    assert(Context::getCurrentContext());
+    Context::getCurrentContext()->useProgram(m_id);
+}
+
+bool Shader::hasStorageBlock(const char* name) const {
+    assert(Context::getCurrentContext());
+
+    return glGetProgramResourceIndex(m_id, GL_SHADER_STORAGE_BLOCK, name) !=
+           GL_INVALID_INDEX;
 }
 
 bool Shader::hasUniform(const char* name) {
@@ -235,4 +271,32 @@ void Shader::setUniform(const char* name, const signed int sint) {
         Application::crashApplication("Uniform does not exist");
     }
 }
+
+Shader::UniformHandle Shader::getUniformHandle(const char* name) const {
+    auto* uf =
+        reinterpret_cast<std::unordered_map<std::string, int>*>(m_uniforms);
+    if (auto l = uf->find(name); l != uf->end()) {
+        return {l->second};
+    }
+
+    return {-1};
+}
+
+void Shader::setUniform(const UniformHandle handle, const glm::mat4& mat) {
+    glProgramUniformMatrix4fv(m_id, handle.location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setUniform(const UniformHandle handle, const unsigned int uint) {
+    glProgramUniform1ui(m_id, handle.location, uint);
+}
+
+void Shader::setUniform(const UniformHandle handle, const signed int sint) {
+    glProgramUniform1i(m_id, handle.location, sint);
+}
+
+void Shader::setUniformArray(const UniformHandle handle,
+                             const int* values,
+                             const std::size_t count) {
+    glProgramUniform1iv(m_id, handle.location, count, values);
+}
 }
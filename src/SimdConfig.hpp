@@ -0,0 +1,26 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_SIMDCONFIG_HPP
+#define SGE_SIMDCONFIG_HPP
+
+// Defines SGE_SSE and includes the SSE2 intrinsics when the compiler targets
+// them. Code using the intrinsics keeps a scalar path for the other targets.
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SGE_SSE
+#include <emmintrin.h>
+#endif
+
+#endif//SGE_SIMDCONFIG_HPP
@@ -19,7 +19,8 @@ namespace sge {
 Sprite::Sprite(Texture* texture,
                const RectangleFloat& textureRect,
                const glm::vec2& size)
-    : m_tex(texture) {
+    : m_tex(texture), m_boundsRevision(0), m_boundsNeedUpdate(true),
+      m_pool(nullptr), m_poolHandle(0) {
     m_vertices[0].pos.x = 0.0f;
     m_vertices[0].pos.y = 0.0f;
     m_vertices[1].pos.y = 0.0f;
@@ -61,12 +62,20 @@ void Sprite::setModelSize(const float w, const float h) {
     m_vertices[2].pos.y = -h;
     m_vertices[3].pos.x = w;
     m_vertices[3].pos.y = -h;
+    m_boundsNeedUpdate  = true;
 }
 
 void Sprite::setModelSize(const glm::vec2& size) {
     setModelSize(size.x, size.y);
 }
 
+void Sprite::setPooledTransform(const TransformPool* pool,
+                                const TransformPool::Handle handle) {
+    m_pool             = pool;
+    m_poolHandle       = handle;
+    m_boundsNeedUpdate = true;
+}
+
 Texture* Sprite::getTexture() const {
     return m_tex;
 }
@@ -87,29 +96,50 @@ RectangleFloat Sprite::getModelBounds() const {
 }
 
 RectangleFloat Sprite::getWorldBounds() const {
-    const glm::vec4 points[] = {
-        getTransform() * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
-        getTransform() * glm::vec4(m_vertices[1].pos.x, 0.0f, 0.0f, 1.0f),
-        getTransform() * glm::vec4(0.0f, m_vertices[2].pos.y, 0.0f, 1.0f),
-        getTransform() *
-            glm::vec4(m_vertices[1].pos.x, m_vertices[2].pos.y, 0.0f, 1.0f)};
-
-    const auto minX =
-        std::min({points[0].x, points[1].x, points[2].x, points[3].x});// Left
-    const auto maxX =
-        std::max({points[0].x, points[1].x, points[2].x, points[3].x});// Right
-    const auto minY =
-        std::min({points[0].y, points[1].y, points[2].y, points[3].y});// Bottom
-    const auto maxY =
-        std::max({points[0].y, points[1].y, points[2].y, points[3].y});// Top
-
-    return RectangleFloat(minX, maxY, maxX - minX, maxY - minY);
+    if (!m_boundsNeedUpdate && m_boundsRevision == getWorldRevision()) {
+        return m_worldBounds;
+    }
+
+    // Corners lie on the z = 0 plane, so only the x and y rows of the
+    // transform are needed
+    const auto& m    = getWorldTransform();
+    const auto w     = m_vertices[1].pos.x;
+    const auto h     = m_vertices[2].pos.y;
+    const float xs[] = {m[3][0],
+                        m[3][0] + m[0][0] * w,
+                        m[3][0] + m[1][0] * h,
+                        m[3][0] + m[0][0] * w + m[1][0] * h};
+    const float ys[] = {m[3][1],
+                        m[3][1] + m[0][1] * w,
+                        m[3][1] + m[1][1] * h,
+                        m[3][1] + m[0][1] * w + m[1][1] * h};
+
+    const auto minX = std::min({xs[0], xs[1], xs[2], xs[3]});// Left
+    const auto maxX = std::max({xs[0], xs[1], xs[2], xs[3]});// Right
+    const auto minY = std::min({ys[0], ys[1], ys[2], ys[3]});// Bottom
+    const auto maxY = std::max({ys[0], ys[1], ys[2], ys[3]});// Top
+
+    m_worldBounds      = RectangleFloat(minX, maxY, maxX - minX, maxY - minY);
+    m_boundsRevision   = getWorldRevision();
+    m_boundsNeedUpdate = false;
+
+    return m_worldBounds;
 }
 
 void Sprite::draw(RenderTarget& target, RenderState renderState) const {
-    renderState.transform *= getTransform();
+    renderState.transform *= getWorldTransform();
     renderState.texture = m_tex;
 
     target.drawQuad(m_vertices, renderState);
 }
+
+const glm::mat4& Sprite::getWorldTransform() const {
+    return m_pool != nullptr ? m_pool->getTransform(m_poolHandle)
+                             : getTransform();
+}
+
+std::uint32_t Sprite::getWorldRevision() const {
+    return m_pool != nullptr ? m_pool->getRevision(m_poolHandle)
+                             : getRevision();
+}
 }
@@ -0,0 +1,210 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/SpriteBatch.hpp>
+#include <SGE/RenderTarget.hpp>
+#include <SGE/Application.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <glad.h>
+
+namespace {
+constexpr GLuint64 fenceTimeout = 1000000;
+
+static_assert(sizeof(sge::SpriteInstance) == 32,
+              "Sprite instances must stay tightly packed");
+
+std::uint16_t packCoordinate(const float coordinate) {
+    return static_cast<std::uint16_t>(
+        std::clamp(coordinate, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+}
+
+namespace sge {
+SpriteBatch::SpriteBatch(Texture* texture,
+                         const std::size_t capacity,
+                         const unsigned int segments)
+    : m_texture(texture), m_capacity(std::max<std::size_t>(capacity, 1)),
+      m_segmentCount(std::max(segments, 1u)), m_segment(0),
+      m_instances(nullptr), m_fences(nullptr), m_mapped(nullptr) {
+    try {
+        m_instances = new std::vector<SpriteInstance>();
+        m_fences    = new std::vector<GLsync>(m_segmentCount, nullptr);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    float corners[]        = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    unsigned int indices[] = {0, 1, 2, 2, 1, 3};
+
+    m_quadVBO.allocate(sizeof(corners), VBO::NoAccess, corners);
+    m_quadEBO.allocate(sizeof(indices), VBO::NoAccess, indices);
+    m_instanceVBO.allocate(sizeof(SpriteInstance) * m_capacity *
+                               m_segmentCount,
+                           VBO::WriteAccess);
+    m_mapped = static_cast<SpriteInstance*>(
+        m_instanceVBO.mapBuffer(0,
+                                m_instanceVBO.getSize(),
+                                VBO::WriteAccess,
+                                true));
+
+    m_vao.bindVBO(m_quadVBO, 0, 0, sizeof(float) * 2);
+    m_vao.bindVBO(m_instanceVBO, 1, 0, sizeof(SpriteInstance));
+    m_vao.setBindingDivisor(1, 1);
+    m_vao.setElementBuffer(m_quadEBO);
+
+    for (unsigned int i = 0; i < 6; i++) {
+        m_vao.enableAttribute(i);
+        m_vao.setAttributeBinding(i, i == 0 ? 0 : 1);
+    }
+    m_vao.setAttributeFormat(0, 2, VAO::Data::Float, false, 0);
+    m_vao.setAttributeFormat(1,
+                             2,
+                             VAO::Data::Float,
+                             false,
+                             offsetof(SpriteInstance, position));
+    m_vao.setAttributeFormat(2,
+                             2,
+                             VAO::Data::Float,
+                             false,
+                             offsetof(SpriteInstance, size));
+    m_vao.setAttributeFormat(3,
+                             1,
+                             VAO::Data::Float,
+                             false,
+                             offsetof(SpriteInstance, rotation));
+    m_vao.setAttributeFormat(4,
+                             4,
+                             VAO::Data::UnsignedByte,
+                             true,
+                             offsetof(SpriteInstance, tint));
+    m_vao.setAttributeFormat(5,
+                             4,
+                             VAO::Data::UnsignedShort,
+                             true,
+                             offsetof(SpriteInstance, textureRect));
+}
+
+SpriteBatch::~SpriteBatch() {
+    auto* fences = reinterpret_cast<std::vector<GLsync>*>(m_fences);
+
+    for (auto* fence : *fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
+
+    delete reinterpret_cast<std::vector<SpriteInstance>*>(m_instances);
+    delete fences;
+}
+
+void SpriteBatch::setTexture(Texture* texture) {
+    m_texture = texture;
+}
+
+Texture* SpriteBatch::getTexture() const {
+    return m_texture;
+}
+
+void SpriteBatch::add(const SpriteInstance& instance) {
+    auto* instances =
+        reinterpret_cast<std::vector<SpriteInstance>*>(m_instances);
+
+    try {
+        instances->push_back(instance);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+void SpriteBatch::add(const glm::vec2& position,
+                      const glm::vec2& size,
+                      const float rotation,
+                      const RectangleFloat& textureRect,
+                      const Color& tint) {
+    add(SpriteInstance{position,
+                       size,
+                       rotation,
+                       tint,
+                       {packCoordinate(textureRect.left),
+                        packCoordinate(textureRect.top),
+                        packCoordinate(textureRect.width),
+                        packCoordinate(textureRect.height)}});
+}
+
+void SpriteBatch::clear() {
+    reinterpret_cast<std::vector<SpriteInstance>*>(m_instances)->clear();
+}
+
+SpriteInstance* SpriteBatch::getInstances() {
+    return reinterpret_cast<std::vector<SpriteInstance>*>(m_instances)
+        ->data();
+}
+
+std::size_t SpriteBatch::getInstanceCount() const {
+    return reinterpret_cast<std::vector<SpriteInstance>*>(m_instances)
+        ->size();
+}
+
+void SpriteBatch::draw(RenderTarget& target, RenderState renderState) const {
+    auto* instances =
+        reinterpret_cast<std::vector<SpriteInstance>*>(m_instances);
+    auto* fences = reinterpret_cast<std::vector<GLsync>*>(m_fences);
+
+    renderState.transform *= getTransform();
+    renderState.texture = m_texture;
+    target.getContext().setCurrent(true);
+
+    for (std::size_t first = 0; first < instances->size();
+         first += m_capacity) {
+        const auto count = std::min(instances->size() - first, m_capacity);
+        const auto base  = m_segment * m_capacity;
+
+        waitForSegment();
+        std::memcpy(m_mapped + base,
+                    instances->data() + first,
+                    sizeof(SpriteInstance) * count);
+        m_instanceVBO.flushChanges(sizeof(SpriteInstance) * base,
+                                   sizeof(SpriteInstance) * count);
+
+        target.drawInstancedQuads(m_vao, base, count, renderState);
+
+        (*fences)[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_segment            = (m_segment + 1) % m_segmentCount;
+    }
+}
+
+void SpriteBatch::waitForSegment() const {
+    auto* fences = reinterpret_cast<std::vector<GLsync>*>(m_fences);
+    auto& fence  = (*fences)[m_segment];
+
+    if (fence == nullptr) {
+        return;
+    }
+
+    GLenum waitReturn = glClientWaitSync(fence, 0, 0);
+    while (waitReturn == GL_TIMEOUT_EXPIRED) {
+        waitReturn =
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+    }
+
+    if (waitReturn == GL_WAIT_FAILED) {
+        Application::crashApplication("Failed to wait for sprite batch fence");
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+}
@@ -0,0 +1,215 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/StaticBatch.hpp>
+#include <SGE/RenderTarget.hpp>
+#include <SGE/Texture.hpp>
+#include <SGE/VertexFormat.hpp>
+#include <SGE/Application.hpp>
+#include "StaticBatchData.hpp"
+#include "VertexTransform.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace sge {
+using namespace batching;
+
+StaticBatch::StaticBatch() : m_data(nullptr) {
+    assert(Context::getCurrentContext());
+    try {
+        m_data = new StaticBatchData;
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+StaticBatch::~StaticBatch() {
+    delete static_cast<StaticBatchData*>(m_data);
+}
+
+void StaticBatch::addTriangle(const Vertex* vertices,
+                              const RenderState& renderState) {
+    const auto transform = loadMatrix(renderState.transform);
+    auto* quad           = append(renderState, 1);
+
+    storeVertex(quad[0], vertices[0], transform, 0.0f);
+    storeVertex(quad[1], vertices[1], transform, 0.0f);
+    storeVertex(quad[2], vertices[2], transform, 0.0f);
+    quad[3] = quad[2];
+}
+
+void StaticBatch::addQuad(const Vertex* vertices,
+                          const RenderState& renderState) {
+    storeQuad(append(renderState, 1),
+              vertices,
+              loadMatrix(renderState.transform),
+              0.0f);
+}
+
+void StaticBatch::addQuads(const Vertex* vertices,
+                           const glm::mat4* transforms,
+                           const std::size_t count,
+                           const RenderState& renderState) {
+    const auto transform = loadMatrix(renderState.transform);
+    auto* quads          = append(renderState, count);
+
+    if (transforms == nullptr) {
+        for (std::size_t i = 0; i < count; i++) {
+            storeQuad(quads + i * 4, vertices + i * 4, transform, 0.0f);
+        }
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            storeQuad(quads + i * 4,
+                      vertices + i * 4,
+                      multiply(transform, transforms[i]),
+                      0.0f);
+        }
+    }
+}
+
+void StaticBatch::build() {
+    assert(Context::getCurrentContext());
+    auto* data = static_cast<StaticBatchData*>(m_data);
+
+    data->groups.clear();
+    data->built = true;
+    if (data->sections.empty()) {
+        return;
+    }
+
+    const auto units = std::min(Texture::getMaximumImageUnits(), 32u);
+    std::vector<BatchVertex> vertices;
+    std::vector<StaticBatchData::DrawCommand> commands;
+    std::vector<unsigned int> indices;
+    std::size_t maxQuads = 0;
+
+    try {
+        vertices.resize(data->vertices.size());
+        commands.reserve(data->sections.size());
+
+        for (const auto& section : data->sections) {
+            if (data->groups.empty() ||
+                data->groups.back().shader != section.shader) {
+                data->groups.push_back(
+                    {section.shader, {}, commands.size(), 0});
+            }
+
+            auto* group  = &data->groups.back();
+            auto texture = std::find(group->textures.begin(),
+                                     group->textures.end(),
+                                     section.texture);
+            auto unit    = static_cast<std::size_t>(texture -
+                                                 group->textures.begin());
+            if (texture == group->textures.end()) {
+                if (group->textures.size() >= units) {
+                    data->groups.push_back(
+                        {section.shader, {}, commands.size(), 0});
+                    group = &data->groups.back();
+                }
+
+                unit = group->textures.size();
+                group->textures.push_back(section.texture);
+            }
+
+            const auto vertex = section.firstQuad * 4;
+            copyVertices(vertices.data() + vertex,
+                         data->vertices.data() + vertex,
+                         section.quads * 4,
+                         static_cast<float>(unit));
+            commands.push_back({static_cast<std::uint32_t>(section.quads * 6),
+                                1,
+                                0,
+                                static_cast<std::int32_t>(vertex),
+                                0});
+            group->commands++;
+            maxQuads = std::max(maxQuads, section.quads);
+        }
+
+        indices.resize(maxQuads * 6);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    for (std::size_t i = 0; i < maxQuads; i++) {
+        const auto vertex  = static_cast<unsigned int>(i * 4);
+        indices[i * 6]     = vertex;
+        indices[i * 6 + 1] = vertex + 1;
+        indices[i * 6 + 2] = vertex + 2;
+        indices[i * 6 + 3] = vertex + 2;
+        indices[i * 6 + 4] = vertex + 1;
+        indices[i * 6 + 5] = vertex + 3;
+    }
+
+    data->vertexBuffer  = VBO();
+    data->indexBuffer   = VBO();
+    data->commandBuffer = VBO();
+    data->vertexBuffer.allocate(sizeof(BatchVertex) * vertices.size(),
+                                VBO::NoAccess,
+                                vertices.data());
+    data->indexBuffer.allocate(sizeof(unsigned int) * indices.size(),
+                               VBO::NoAccess,
+                               indices.data());
+    data->commandBuffer.allocate(sizeof(StaticBatchData::DrawCommand) *
+                                     commands.size(),
+                                 VBO::NoAccess,
+                                 commands.data());
+
+    data->vertexArray.bindVBO(data->vertexBuffer, 0, 0, sizeof(BatchVertex));
+    VertexFormat<BatchVertex>::configure(data->vertexArray, 0);
+    data->vertexArray.setElementBuffer(data->indexBuffer);
+}
+
+void StaticBatch::clear() {
+    auto* data = static_cast<StaticBatchData*>(m_data);
+
+    data->vertices.clear();
+    data->sections.clear();
+}
+
+bool StaticBatch::isBuilt() const {
+    return static_cast<StaticBatchData*>(m_data)->built;
+}
+
+std::size_t StaticBatch::getQuadCount() const {
+    return static_cast<StaticBatchData*>(m_data)->vertices.size() / 4;
+}
+
+void StaticBatch::draw(RenderTarget& target, RenderState renderState) const {
+    target.drawStatic(*this, renderState);
+}
+
+Vertex* StaticBatch::append(const RenderState& renderState,
+                            const std::size_t quads) {
+    auto* data        = static_cast<StaticBatchData*>(m_data);
+    const auto vertex = data->vertices.size();
+
+    data->built = false;
+    try {
+        data->vertices.resize(vertex + quads * 4);
+
+        if (!data->sections.empty() &&
+            data->sections.back().shader == renderState.shader &&
+            data->sections.back().texture == renderState.texture) {
+            data->sections.back().quads += quads;
+        } else {
+            data->sections.push_back(
+                {renderState.shader, renderState.texture, vertex / 4, quads});
+        }
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    return &data->vertices[vertex];
+}
+}
@@ -0,0 +1,73 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_STATICBATCHDATA_HPP
+#define SGE_STATICBATCHDATA_HPP
+
+#include <SGE/Vertex.hpp>
+#include <SGE/VAO.hpp>
+#include <SGE/VBO.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace sge {
+class Shader;
+class Texture;
+
+/**
+ * \brief Geometry of a static batch
+ *
+ *
+ * Recorded vertices are stored transformed, four per quad, and consecutive
+ * quads with the same state form a section. Building uploads the vertices
+ * once and records a draw command per section. Consecutive sections with the
+ * same shader whose textures fit in the texture units form a group, which is
+ * drawn with a single multi-draw call.
+ */
+struct StaticBatchData {
+    struct Section {
+        Shader* shader;
+        Texture* texture;
+        std::size_t firstQuad;
+        std::size_t quads;
+    };
+
+    struct Group {
+        Shader* shader;
+        std::vector<Texture*> textures;
+        std::size_t firstCommand;
+        std::size_t commands;
+    };
+
+    // Command layout read by glMultiDrawElementsIndirect
+    struct DrawCommand {
+        std::uint32_t count;
+        std::uint32_t instanceCount;
+        std::uint32_t firstIndex;
+        std::int32_t baseVertex;
+        std::uint32_t baseInstance;
+    };
+
+    std::vector<Vertex> vertices;
+    std::vector<Section> sections;
+    std::vector<Group> groups;
+    bool built = false;
+    VAO vertexArray;
+    VBO vertexBuffer;
+    VBO indexBuffer;
+    VBO commandBuffer;
+};
+}
+
+#endif//SGE_STATICBATCHDATA_HPP
@@ -17,20 +17,27 @@
 #include <SGE/Context.hpp>
 #include <SGE/Filesystem.hpp>
 #include <SGE/InputFile.hpp>
+#include <SGE/MipChain.hpp>
+#include "BindlessTexture.hpp"
+#include "CompressedTexture.hpp"
+#include "TextureStreamer.hpp"
 #include <glad.h>
 #include <stb_image.h>
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 namespace sge {
 Texture::Texture()
     : m_id(0), m_size(0, 0), m_wrapMode(WrapMode::ClampToBorder),
-      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false) {
+      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false), m_handle(0),
+      m_stream(nullptr), m_mipmapMode(MipmapMode::Gpu), m_levels(0) {
 }
 
 Texture::Texture(const char* file)
     : m_id(0), m_size(0, 0), m_wrapMode(WrapMode::ClampToBorder),
-      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false) {
+      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false), m_handle(0),
+      m_stream(nullptr), m_mipmapMode(MipmapMode::Gpu), m_levels(0) {
     if (!loadFromFile(file)) {
         Application::crashApplication("Failed to load texture");
     }
@@ -38,24 +45,29 @@ Texture::Texture(const char* file)
 
 Texture::Texture(const std::size_t size, const void* data)
     : m_id(0), m_size(0, 0), m_wrapMode(WrapMode::ClampToBorder),
-      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false) {
-    if (loadFromMemory(size, data)) {
+      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false), m_handle(0),
+      m_stream(nullptr), m_mipmapMode(MipmapMode::Gpu), m_levels(0) {
+    if (!loadFromMemory(size, data)) {
         Application::crashApplication("Failed to load texture");
     }
 }
 
 Texture::Texture(const Image& image)
     : m_id(0), m_size(0, 0), m_wrapMode(WrapMode::ClampToBorder),
-      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false) {
-    if (loadFromImage(image)) {
+      m_filterMode(FilterMode::Nearest), m_hasMipmaps(false), m_handle(0),
+      m_stream(nullptr), m_mipmapMode(MipmapMode::Gpu), m_levels(0) {
+    if (!loadFromImage(image)) {
         Application::crashApplication("Failed to load texture");
     }
 }
 
 Texture::~Texture() {
+    cancelStream();
     if (m_id != 0) {
         assert(Context::getCurrentContext() != nullptr);
+        releaseHandle();
         glDeleteTextures(1, &m_id);
+        Context::objectDeleted();
     }
 }
 
@@ -74,12 +86,19 @@ bool Texture::loadFromFile(const char* path) {
 
 bool Texture::loadFromMemory(const std::size_t size, const void* data) {
     assert(Context::getCurrentContext() != nullptr);
+    cancelStream();
 
     if (m_id != 0) {
+        releaseHandle();
         glDeleteTextures(1, &m_id);
+        Context::objectDeleted();
+        m_id = 0;
+    }
+
+    if (compressed::isContainer(size, data)) {
+        return loadCompressed(size, data);
     }
 
-    glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
     int w, h;
     auto* imageData = stbi_load_from_memory(static_cast<const stbi_uc*>(data),
                                             size,
@@ -99,57 +118,207 @@ bool Texture::loadFromMemory(const std::size_t size, const void* data) {
     m_size.x = static_cast<unsigned int>(w);
     m_size.y = static_cast<unsigned int>(h);
 
-    const GLint texLevels = 1 + std::floor(std::log2(std::max(w, h)));
-
-    glTextureStorage2D(m_id, texLevels, GL_RGBA8, m_size.x, m_size.y);
-    glTextureSubImage2D(m_id,
-                        0,
-                        0,
-                        0,
-                        m_size.x,
-                        m_size.y,
-                        GL_RGBA,
-                        GL_UNSIGNED_BYTE,
-                        imageData);
-
+    const auto stored = storePixels(imageData);
     stbi_image_free(imageData);
 
-    return true;
+    return stored;
 }
 
 bool Texture::loadFromImage(const Image& image) {
     assert(Context::getCurrentContext() != nullptr);
+    cancelStream();
 
     if (m_id != 0) {
+        releaseHandle();
         glDeleteTextures(1, &m_id);
+        Context::objectDeleted();
+        m_id = 0;
     }
 
     if (image.getSize().x == 0 || image.getSize().y == 0) {
         return false;
     }
 
+    m_size = image.getSize();
+
+    return storePixels(image.getPixelData());
+}
+
+bool Texture::loadFromMipChain(const MipChain& chain) {
+    assert(Context::getCurrentContext() != nullptr);
+    cancelStream();
+
+    if (m_id != 0) {
+        releaseHandle();
+        glDeleteTextures(1, &m_id);
+        Context::objectDeleted();
+        m_id = 0;
+    }
+
+    if (chain.getLevelCount() == 0) {
+        return false;
+    }
+
+    const auto& baseSize = chain.getLevelSize(0);
+    if (baseSize.x > getMaximumSize() || baseSize.y > getMaximumSize()) {
+        return false;
+    }
+
     glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
 
-    m_size = image.getSize();
+    m_size       = baseSize;
+    m_levels     = m_mipmapMode == MipmapMode::None
+                       ? 1
+                       : chain.getLevelCount();
+    m_hasMipmaps = m_levels > 1;
+    glTextureStorage2D(m_id, m_levels, GL_RGBA8, m_size.x, m_size.y);
+    for (unsigned int i = 0; i < m_levels; i++) {
+        const auto size = chain.getLevelSize(i);
+        glTextureSubImage2D(m_id,
+                            i,
+                            0,
+                            0,
+                            size.x,
+                            size.y,
+                            GL_RGBA,
+                            GL_UNSIGNED_BYTE,
+                            chain.getLevelPixels(i));
+    }
+
+    return true;
+}
+
+bool Texture::create(const glm::uvec2& size) {
+    assert(Context::getCurrentContext() != nullptr);
+    cancelStream();
+
+    if (m_id != 0) {
+        releaseHandle();
+        glDeleteTextures(1, &m_id);
+        Context::objectDeleted();
+        m_id = 0;
+    }
+
+    if (size.x == 0 || size.y == 0 || size.x > getMaximumSize() ||
+        size.y > getMaximumSize()) {
+        return false;
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+
+    m_size       = size;
+    m_levels     = m_mipmapMode == MipmapMode::None
+                       ? 1
+                       : getLevelCount(size);
+    m_hasMipmaps = false;
+    glTextureStorage2D(m_id, m_levels, GL_RGBA8, m_size.x, m_size.y);
+    glClearTexImage(m_id, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    return true;
+}
+
+void Texture::update(const unsigned char* pixels,
+                     const glm::uvec2& size,
+                     const glm::uvec2& position) {
+    assert(Context::getCurrentContext() != nullptr);
+    assert(position.x + size.x <= m_size.x && position.y + size.y <= m_size.y);
 
-    const GLint texLevels =
-        1 + std::floor(std::log2(std::max(m_size.x, m_size.y)));
-    glTextureStorage2D(m_id, texLevels, GL_RGBA8, m_size.x, m_size.y);
     glTextureSubImage2D(m_id,
                         0,
-                        0,
-                        0,
-                        m_size.x,
-                        m_size.y,
+                        position.x,
+                        position.y,
+                        size.x,
+                        size.y,
                         GL_RGBA,
                         GL_UNSIGNED_BYTE,
-                        image.getPixelData());
+                        pixels);
+
+    m_hasMipmaps = false;
+}
+
+void Texture::update(const Image& image, const glm::uvec2& position) {
+    update(image.getPixelData(), image.getSize(), position);
+}
+
+bool Texture::loadAsync(const char* path) {
+    assert(Context::getCurrentContext() != nullptr);
+    cancelStream();
+
+    if (m_id != 0) {
+        releaseHandle();
+        glDeleteTextures(1, &m_id);
+        Context::objectDeleted();
+        m_id = 0;
+    }
+    m_size       = glm::uvec2(0, 0);
+    m_levels     = 0;
+    m_hasMipmaps = false;
+
+    if (path == nullptr) {
+        return false;
+    }
+
+    try {
+        m_stream = new std::shared_ptr<StreamRequest>(
+            TextureStreamer::enqueue(path, m_mipmapMode));
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
 
     return true;
 }
 
+bool Texture::isReady() {
+    if (m_stream == nullptr) {
+        return m_id != 0;
+    }
+
+    assert(Context::getCurrentContext() != nullptr);
+    auto& request = **static_cast<std::shared_ptr<StreamRequest>*>(m_stream);
+    {
+        std::lock_guard<std::mutex> lock(request.mutex);
+
+        if (request.state == StreamRequest::State::Queued) {
+            return false;
+        }
+
+        if (request.state == StreamRequest::State::Uploaded) {
+            const auto waitReturn =
+                glClientWaitSync(static_cast<GLsync>(request.fence), 0, 0);
+            if (waitReturn != GL_ALREADY_SIGNALED &&
+                waitReturn != GL_CONDITION_SATISFIED) {
+                return false;
+            }
+
+            glDeleteSync(static_cast<GLsync>(request.fence));
+            m_id            = request.texture;
+            m_size          = request.size;
+            m_levels        = request.levels;
+            m_hasMipmaps    = request.levels > 1;
+            request.fence   = nullptr;
+            request.texture = 0;
+            request.state   = StreamRequest::State::Failed;
+        }
+    }
+
+    delete static_cast<std::shared_ptr<StreamRequest>*>(m_stream);
+    m_stream = nullptr;
+
+    return m_id != 0;
+}
+
+bool Texture::isLoading() const {
+    return m_stream != nullptr;
+}
+
 void Texture::setWrapMode(const WrapMode mode) {
     assert(Context::getCurrentContext() != nullptr);
+    // A texture with a bindless handle has immutable sampler state, even
+    // after the handle was made non resident
+    if (m_handle != 0) {
+        return;
+    }
+
     GLuint m;
     switch (mode) {
     case WrapMode::Repeat:
@@ -174,6 +343,10 @@ void Texture::setWrapMode(const WrapMode mode) {
 
 void Texture::setFilterMode(const FilterMode mode) {
     assert(Context::getCurrentContext() != nullptr);
+    if (m_handle != 0) {
+        return;
+    }
+
     GLuint m;
     switch (mode) {
     case FilterMode::Nearest:
@@ -217,15 +390,32 @@ void Texture::setFilterMode(const FilterMode mode) {
     m_filterMode = mode;
 }
 
+void Texture::setMipmapMode(const MipmapMode mode) {
+    m_mipmapMode = mode;
+}
+
 void Texture::generateMipmaps() {
     assert(Context::getCurrentContext() != nullptr);
-    glGenerateTextureMipmap(m_id);
+
+    if (m_levels > 1 && !m_hasMipmaps) {
+        glGenerateTextureMipmap(m_id);
+        m_hasMipmaps = true;
+    }
 }
 
 void Texture::bind(const int unit) {
     assert(Context::getCurrentContext() != nullptr);
-    glBindTextureUnit(unit, m_id);
-    m_hasMipmaps = true;
+    Context::getCurrentContext()->bindTexture(unit, m_id);
+}
+
+std::uint64_t Texture::getHandle() {
+    assert(Context::getCurrentContext() != nullptr);
+
+    if (m_handle == 0 && m_id != 0 && bindless::isAvailable()) {
+        m_handle = bindless::makeResident(m_id);
+    }
+
+    return m_handle;
 }
 
 const glm::uvec2& Texture::getSize() const {
@@ -240,6 +430,10 @@ Texture::FilterMode Texture::getFilterMode() const {
     return m_filterMode;
 }
 
+Texture::MipmapMode Texture::getMipmapMode() const {
+    return m_mipmapMode;
+}
+
 bool Texture::hasMipmaps() const {
     return m_hasMipmaps;
 }
@@ -259,4 +453,140 @@ unsigned int Texture::getMaximumImageUnits() {
 
     return r;
 }
+
+void Texture::releaseHandle() {
+    if (m_handle != 0) {
+        bindless::makeNonResident(m_handle);
+        m_handle = 0;
+    }
+}
+
+void Texture::cancelStream() {
+    if (m_stream == nullptr) {
+        return;
+    }
+
+    auto* stream = static_cast<std::shared_ptr<StreamRequest>*>(m_stream);
+    {
+        std::lock_guard<std::mutex> lock((*stream)->mutex);
+        (*stream)->cancelled = true;
+        TextureStreamer::release(**stream);
+    }
+
+    delete stream;
+    m_stream = nullptr;
+}
+
+bool Texture::loadCompressed(const std::size_t size, const void* data) {
+    compressed::ImageData image;
+
+    if (!compressed::read(size, data, image)) {
+        return false;
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+
+    // Only the first level is kept when mipmaps are not wanted
+    const auto levels = m_mipmapMode == MipmapMode::None
+                            ? 1
+                            : static_cast<GLsizei>(image.levels.size());
+
+    m_size       = image.size;
+    m_levels     = static_cast<unsigned int>(levels);
+    m_hasMipmaps = levels > 1;
+
+    if (compressed::isSupported(image.format)) {
+        const auto format = compressed::getInternalFormat(image.format);
+
+        glTextureStorage2D(m_id, levels, format, m_size.x, m_size.y);
+        for (GLsizei i = 0; i < levels; i++) {
+            const auto& level = image.levels[i];
+            glCompressedTextureSubImage2D(m_id,
+                                          i,
+                                          0,
+                                          0,
+                                          level.extent.x,
+                                          level.extent.y,
+                                          format,
+                                          level.size,
+                                          level.data);
+        }
+
+        return true;
+    }
+
+    // Only S3TC formats can be unsupported, which are decoded on the CPU
+    const auto srgb = image.format == compressed::Format::BC1Srgb ||
+                      image.format == compressed::Format::BC3Srgb;
+    std::vector<unsigned char> pixels;
+
+    try {
+        pixels.resize(static_cast<std::size_t>(m_size.x) * m_size.y * 4);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    glTextureStorage2D(m_id,
+                       levels,
+                       srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8,
+                       m_size.x,
+                       m_size.y);
+    for (GLsizei i = 0; i < levels; i++) {
+        const auto& level = image.levels[i];
+
+        compressed::decompress(image.format, level, pixels.data());
+        glTextureSubImage2D(m_id,
+                            i,
+                            0,
+                            0,
+                            level.extent.x,
+                            level.extent.y,
+                            GL_RGBA,
+                            GL_UNSIGNED_BYTE,
+                            pixels.data());
+    }
+
+    return true;
+}
+
+bool Texture::storePixels(const unsigned char* pixels) {
+    if (m_mipmapMode == MipmapMode::Cpu) {
+        MipChain chain;
+
+        return chain.generate(pixels, m_size) && loadFromMipChain(chain);
+    }
+
+    if (m_size.x > getMaximumSize() || m_size.y > getMaximumSize()) {
+        return false;
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+
+    m_levels     = m_mipmapMode == MipmapMode::None
+                       ? 1
+                       : getLevelCount(m_size);
+    m_hasMipmaps = false;
+    glTextureStorage2D(m_id, m_levels, GL_RGBA8, m_size.x, m_size.y);
+    glTextureSubImage2D(m_id,
+                        0,
+                        0,
+                        0,
+                        m_size.x,
+                        m_size.y,
+                        GL_RGBA,
+                        GL_UNSIGNED_BYTE,
+                        pixels);
+
+    if (m_levels > 1) {
+        glGenerateTextureMipmap(m_id);
+        m_hasMipmaps = true;
+    }
+
+    return true;
+}
+
+unsigned int Texture::getLevelCount(const glm::uvec2& size) {
+    return 1 + static_cast<unsigned int>(
+                   std::floor(std::log2(std::max(size.x, size.y))));
+}
 }
@@ -0,0 +1,236 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/TextureAtlas.hpp>
+#include <SGE/Application.hpp>
+#include <SGE/Image.hpp>
+#include <SGE/Texture.hpp>
+#include "ImageUtils.hpp"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+// Top edge of the packed area over [x, x + width)
+struct SkylineNode {
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+};
+
+struct Page {
+    std::unique_ptr<sge::Texture> texture;
+    std::vector<SkylineNode> skyline;
+};
+
+using Pages = std::vector<Page>;
+
+// Returns the height an area starting at the node would be placed at, or
+// false if it does not fit
+bool fitAt(const std::vector<SkylineNode>& skyline,
+           std::size_t node,
+           const glm::uvec2& size,
+           const glm::uvec2& pageSize,
+           unsigned int& y) {
+    const auto x = skyline[node].x;
+    if (x + size.x > pageSize.x) {
+        return false;
+    }
+
+    y                    = 0;
+    unsigned int covered = 0;
+    for (; covered < size.x; node++) {
+        y = std::max(y, skyline[node].y);
+        if (y + size.y > pageSize.y) {
+            return false;
+        }
+        covered += skyline[node].width;
+    }
+
+    return true;
+}
+
+// Finds the bottom-left position of an area, preferring the lowest top edge
+bool findPosition(const Page& page,
+                  const glm::uvec2& size,
+                  const glm::uvec2& pageSize,
+                  std::size_t& node,
+                  glm::uvec2& position) {
+    auto bestTop   = std::numeric_limits<unsigned int>::max();
+    auto bestWidth = std::numeric_limits<unsigned int>::max();
+    bool found     = false;
+
+    for (std::size_t i = 0; i < page.skyline.size(); i++) {
+        unsigned int y = 0;
+        if (!fitAt(page.skyline, i, size, pageSize, y)) {
+            continue;
+        }
+
+        const auto top = y + size.y;
+        if (top < bestTop ||
+            (top == bestTop && page.skyline[i].width < bestWidth)) {
+            bestTop    = top;
+            bestWidth  = page.skyline[i].width;
+            node       = i;
+            position.x = page.skyline[i].x;
+            position.y = y;
+            found      = true;
+        }
+    }
+
+    return found;
+}
+
+void addSkyline(std::vector<SkylineNode>& skyline,
+                const std::size_t node,
+                const glm::uvec2& position,
+                const glm::uvec2& size) {
+    skyline.insert(skyline.begin() + node,
+                   SkylineNode{position.x, position.y + size.y, size.x});
+
+    // Shrink or remove the nodes now covered by the new one
+    const auto right = position.x + size.x;
+    auto i           = node + 1;
+    while (i < skyline.size() && skyline[i].x < right) {
+        const auto shrink = std::min(right - skyline[i].x, skyline[i].width);
+
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width == 0) {
+            skyline.erase(skyline.begin() + i);
+        } else {
+            break;
+        }
+    }
+
+    for (i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+}
+}
+
+namespace sge {
+TextureAtlas::TextureAtlas(const glm::uvec2& pageSize,
+                           const unsigned int padding)
+    : m_pageSize(pageSize), m_padding(padding), m_pages(nullptr) {
+    try {
+        m_pages = new Pages;
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+TextureAtlas::~TextureAtlas() {
+    delete static_cast<Pages*>(m_pages);
+}
+
+bool TextureAtlas::insert(const Image& image, Region& region) {
+    return insert(image.getPixelData(), image.getSize(), region);
+}
+
+bool TextureAtlas::insert(const unsigned char* pixels,
+                          const glm::uvec2& size,
+                          Region& region) {
+    auto* pages = static_cast<Pages*>(m_pages);
+
+    if (pages->empty()) {
+        const auto maximum = Texture::getMaximumSize();
+
+        m_pageSize.x = std::min(m_pageSize.x, maximum);
+        m_pageSize.y = std::min(m_pageSize.y, maximum);
+    }
+
+    const auto padded = size + glm::uvec2(m_padding * 2, m_padding * 2);
+    if (pixels == nullptr || size.x == 0 || size.y == 0 ||
+        padded.x > m_pageSize.x || padded.y > m_pageSize.y) {
+        return false;
+    }
+
+    Page* page       = nullptr;
+    std::size_t node = 0;
+    glm::uvec2 position;
+    for (auto& candidate : *pages) {
+        if (findPosition(candidate, padded, m_pageSize, node, position)) {
+            page = &candidate;
+            break;
+        }
+    }
+
+    std::vector<unsigned char> paddedPixels;
+    try {
+        if (page == nullptr) {
+            pages->push_back(
+                Page{std::make_unique<Texture>(),
+                     std::vector<SkylineNode>{{0, 0, m_pageSize.x}}});
+            page = &pages->back();
+
+            // Only the base level is ever filled
+            page->texture->setMipmapMode(Texture::MipmapMode::None);
+            if (!page->texture->create(m_pageSize)) {
+                pages->pop_back();
+                return false;
+            }
+            findPosition(*page, padded, m_pageSize, node, position);
+        }
+
+        addSkyline(page->skyline, node, position, padded);
+        if (m_padding != 0) {
+            imageutils::padPixels(pixels, size, m_padding, paddedPixels);
+        }
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    if (m_padding != 0) {
+        page->texture->update(paddedPixels.data(), padded, position);
+    } else {
+        page->texture->update(pixels, size, position);
+    }
+
+    const auto left = position.x + m_padding;
+    const auto top  = position.y + m_padding;
+
+    region.texture   = page->texture.get();
+    region.pixels    = RectangleInt(left, top, size.x, size.y);
+    region.rectangle = RectangleFloat(
+        static_cast<float>(left) / static_cast<float>(m_pageSize.x),
+        static_cast<float>(top) / static_cast<float>(m_pageSize.y),
+        static_cast<float>(size.x) / static_cast<float>(m_pageSize.x),
+        static_cast<float>(size.y) / static_cast<float>(m_pageSize.y));
+
+    return true;
+}
+
+void TextureAtlas::clear() {
+    static_cast<Pages*>(m_pages)->clear();
+}
+
+std::size_t TextureAtlas::getPageCount() const {
+    return static_cast<Pages*>(m_pages)->size();
+}
+
+Texture* TextureAtlas::getPage(const std::size_t index) const {
+    return (*static_cast<Pages*>(m_pages))[index].texture.get();
+}
+
+const glm::uvec2& TextureAtlas::getPageSize() const {
+    return m_pageSize;
+}
+}
@@ -0,0 +1,459 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "TextureStreamer.hpp"
+#include <SGE/Application.hpp>
+#include <SGE/Context.hpp>
+#include <SGE/Filesystem.hpp>
+#include <SGE/InputFile.hpp>
+#include <SGE/Log.hpp>
+#include <SGE/MipChain.hpp>
+#include <SGE/VBO.hpp>
+#include "CompressedTexture.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <glad.h>
+#include <stb_image.h>
+
+namespace {
+constexpr std::size_t stagingSize = 32 * 1024 * 1024;
+constexpr GLuint64 fenceTimeout   = 1000000;
+
+// Range of the staging buffer read by an upload still in flight
+struct StagingRange {
+    std::size_t begin;
+    std::size_t end;
+    GLsync fence;
+};
+
+// Persistently mapped staging buffer, written as a ring
+struct StagingRing {
+    sge::VBO& buffer;
+    unsigned char* mapped;
+    std::deque<StagingRange> inFlight;
+    std::size_t head;
+};
+
+struct StreamerData {
+    sge::Context* context;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<sge::StreamRequest>> queue;
+    bool stopping;
+};
+
+StreamerData* streamer = nullptr;
+
+void waitFence(const GLsync fence) {
+    GLenum waitReturn = glClientWaitSync(fence, 0, 0);
+    while (waitReturn == GL_TIMEOUT_EXPIRED) {
+        waitReturn =
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+    }
+
+    if (waitReturn == GL_WAIT_FAILED) {
+        sge::Application::crashApplication("Failed to wait for upload fence");
+    }
+}
+
+bool readFile(const std::string& path, std::vector<unsigned char>& buffer) {
+    if (!sge::Filesystem::exists(path.c_str())) {
+        return false;
+    }
+
+    const auto fileSize = sge::Filesystem::getFileSize(path.c_str());
+    sge::InputFile file;
+
+    if (!file.open(path.c_str())) {
+        return false;
+    }
+
+    try {
+        buffer.resize(fileSize);
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+    file.read(fileSize, buffer.data());
+
+    return true;
+}
+
+// Copies data into the staging ring, then calls upload with the source the
+// OpenGL call reads from while the pixel unpack buffer is bound
+template<typename F>
+void stage(StagingRing& ring,
+           const void* data,
+           const std::size_t bytes,
+           const F& upload) {
+    if (bytes > stagingSize) {
+        // Data larger than the staging buffer is copied from client memory
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload(data);
+        ring.buffer.bindPixelUnpack();
+        return;
+    }
+
+    if (ring.head + bytes > stagingSize) {
+        ring.head = 0;
+    }
+
+    // After wrapping, the oldest range may not overlap the write while newer
+    // ones behind it do, so the whole deque is searched. Fences signal in
+    // order, so waiting for the last overlapping range retires every range
+    // before it as well
+    auto& inFlight = ring.inFlight;
+    auto last      = inFlight.end();
+    for (auto r = inFlight.begin(); r != inFlight.end(); ++r) {
+        if (r->begin < ring.head + bytes && ring.head < r->end) {
+            last = r;
+        }
+    }
+    if (last != inFlight.end()) {
+        waitFence(last->fence);
+        for (auto r = inFlight.begin(); r != last + 1; ++r) {
+            glDeleteSync(r->fence);
+        }
+        inFlight.erase(inFlight.begin(), last + 1);
+    }
+
+    std::memcpy(ring.mapped + ring.head, data, bytes);
+    ring.buffer.flushChanges(ring.head, bytes);
+    upload(reinterpret_cast<const void*>(ring.head));
+
+    try {
+        inFlight.push_back(StagingRange{
+            ring.head,
+            ring.head + bytes,
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+    ring.head += bytes;
+}
+
+void uploadLevel(StagingRing& ring,
+                 const GLuint texture,
+                 const GLint level,
+                 const glm::uvec2& size,
+                 const unsigned char* pixels) {
+    const auto bytes = static_cast<std::size_t>(size.x) * size.y * 4;
+
+    stage(ring, pixels, bytes, [&](const void* source) {
+        glTextureSubImage2D(texture,
+                            level,
+                            0,
+                            0,
+                            size.x,
+                            size.y,
+                            GL_RGBA,
+                            GL_UNSIGNED_BYTE,
+                            source);
+    });
+}
+
+// Creates a texture from an image decoded with stb_image, returns 0 if the
+// image can't be decoded or is larger than the maximum texture size
+GLuint loadImage(StagingRing& ring,
+                 const std::vector<unsigned char>& buffer,
+                 const sge::Texture::MipmapMode mipmapMode,
+                 glm::uvec2& size,
+                 GLint& levels) {
+    int w, h;
+    auto* pixels = stbi_load_from_memory(
+        buffer.data(), buffer.size(), &w, &h, NULL, STBI_rgb_alpha);
+    const auto maximum = static_cast<int>(sge::Texture::getMaximumSize());
+    if (pixels == nullptr || w <= 0 || h <= 0 || w > maximum || h > maximum) {
+        if (pixels != nullptr) {
+            stbi_image_free(pixels);
+        }
+
+        return 0;
+    }
+
+    GLuint texture = 0;
+    size           = glm::uvec2(w, h);
+    levels         = 1;
+
+    if (mipmapMode == sge::Texture::MipmapMode::Cpu) {
+        // The chain is filtered here, so the main thread never pays for it
+        sge::MipChain chain;
+        const auto generated = chain.generate(pixels, size);
+        stbi_image_free(pixels);
+        if (!generated) {
+            return 0;
+        }
+
+        levels = static_cast<GLint>(chain.getLevelCount());
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+        glTextureStorage2D(texture, levels, GL_RGBA8, size.x, size.y);
+        for (GLint i = 0; i < levels; i++) {
+            uploadLevel(ring,
+                        texture,
+                        i,
+                        chain.getLevelSize(i),
+                        chain.getLevelPixels(i));
+        }
+
+        return texture;
+    }
+
+    if (mipmapMode == sge::Texture::MipmapMode::Gpu) {
+        levels = 1 + std::floor(std::log2(std::max(size.x, size.y)));
+    }
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    glTextureStorage2D(texture, levels, GL_RGBA8, size.x, size.y);
+    uploadLevel(ring, texture, 0, size, pixels);
+    stbi_image_free(pixels);
+
+    if (levels > 1) {
+        glGenerateTextureMipmap(texture);
+    }
+
+    return texture;
+}
+
+// Creates a texture from a DDS or KTX2 container, keeping its stored levels
+// like Texture::loadFromMemory. Returns 0 if the container is invalid
+GLuint loadContainer(StagingRing& ring,
+                     const std::vector<unsigned char>& buffer,
+                     const sge::Texture::MipmapMode mipmapMode,
+                     glm::uvec2& size,
+                     GLint& levels) {
+    sge::compressed::ImageData image;
+
+    if (!sge::compressed::read(buffer.size(), buffer.data(), image)) {
+        return 0;
+    }
+
+    GLuint texture = 0;
+    size           = image.size;
+    levels         = mipmapMode == sge::Texture::MipmapMode::None
+                         ? 1
+                         : static_cast<GLint>(image.levels.size());
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+
+    if (sge::compressed::isSupported(image.format)) {
+        const auto format = sge::compressed::getInternalFormat(image.format);
+
+        glTextureStorage2D(texture, levels, format, size.x, size.y);
+        for (GLint i = 0; i < levels; i++) {
+            const auto& level = image.levels[i];
+            stage(ring, level.data, level.size, [&](const void* source) {
+                glCompressedTextureSubImage2D(texture,
+                                              i,
+                                              0,
+                                              0,
+                                              level.extent.x,
+                                              level.extent.y,
+                                              format,
+                                              level.size,
+                                              source);
+            });
+        }
+
+        return texture;
+    }
+
+    // Only S3TC formats can be unsupported, which are decoded here
+    const auto srgb = image.format == sge::compressed::Format::BC1Srgb ||
+                      image.format == sge::compressed::Format::BC3Srgb;
+    std::vector<unsigned char> pixels;
+
+    try {
+        pixels.resize(static_cast<std::size_t>(size.x) * size.y * 4);
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+
+    glTextureStorage2D(
+        texture, levels, srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, size.x, size.y);
+    for (GLint i = 0; i < levels; i++) {
+        const auto& level = image.levels[i];
+
+        sge::compressed::decompress(image.format, level, pixels.data());
+        uploadLevel(ring, texture, i, level.extent, pixels.data());
+    }
+
+    return texture;
+}
+}
+
+namespace sge {
+std::shared_ptr<StreamRequest>
+TextureStreamer::enqueue(const char* path,
+                         const Texture::MipmapMode mipmapMode) {
+    std::shared_ptr<StreamRequest> request;
+
+    try {
+        request             = std::make_shared<StreamRequest>();
+        request->path       = path;
+        request->mipmapMode = mipmapMode;
+        request->state      = StreamRequest::State::Queued;
+        request->cancelled  = false;
+        request->texture    = 0;
+        request->size       = glm::uvec2(0, 0);
+        request->levels     = 0;
+        request->fence      = nullptr;
+
+        if (streamer == nullptr) {
+            // Creating a context makes it current, so the caller's context
+            // has to be restored before the loader thread takes it over
+            auto* previous = Context::getCurrentContext();
+
+            streamer           = new StreamerData;
+            streamer->stopping = false;
+            streamer->context  = new Context;
+            streamer->context->setCurrent(false);
+            if (previous != nullptr) {
+                previous->setCurrent(true);
+            }
+
+            streamer->thread = std::thread(run);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(streamer->mutex);
+            streamer->queue.push_back(request);
+        }
+        streamer->wake.notify_one();
+    } catch (...) {
+        Application::crashApplication("Failed to queue texture load");
+    }
+
+    return request;
+}
+
+void TextureStreamer::shutdown() {
+    if (streamer == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(streamer->mutex);
+        streamer->stopping = true;
+
+        for (auto& request : streamer->queue) {
+            std::lock_guard<std::mutex> requestLock(request->mutex);
+            request->state = StreamRequest::State::Failed;
+        }
+        streamer->queue.clear();
+    }
+    streamer->wake.notify_one();
+    streamer->thread.join();
+
+    delete streamer->context;
+    delete streamer;
+    streamer = nullptr;
+}
+
+void TextureStreamer::release(StreamRequest& request) {
+    if (request.state != StreamRequest::State::Uploaded) {
+        return;
+    }
+
+    glDeleteSync(static_cast<GLsync>(request.fence));
+    glDeleteTextures(1, &request.texture);
+    Context::objectDeleted();
+
+    request.fence   = nullptr;
+    request.texture = 0;
+    request.state   = StreamRequest::State::Failed;
+}
+
+void TextureStreamer::run() {
+    streamer->context->setCurrent(true);
+
+    {
+        VBO staging(stagingSize, VBO::WriteAccess);
+        StagingRing ring{staging,
+                         static_cast<unsigned char*>(staging.mapBuffer(
+                             0, stagingSize, VBO::WriteAccess)),
+                         {},
+                         0};
+
+        staging.bindPixelUnpack();
+        while (true) {
+            std::shared_ptr<StreamRequest> request;
+            {
+                std::unique_lock<std::mutex> lock(streamer->mutex);
+                streamer->wake.wait(lock, []() {
+                    return streamer->stopping || !streamer->queue.empty();
+                });
+                if (streamer->stopping) {
+                    break;
+                }
+                request = streamer->queue.front();
+                streamer->queue.pop_front();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(request->mutex);
+                if (request->cancelled) {
+                    continue;
+                }
+            }
+
+            std::vector<unsigned char> buffer;
+            glm::uvec2 size(0, 0);
+            GLint texLevels = 1;
+            GLuint texture  = 0;
+
+            if (readFile(request->path, buffer)) {
+                const auto mode = request->mipmapMode;
+                texture =
+                    compressed::isContainer(buffer.size(), buffer.data())
+                        ? loadContainer(ring, buffer, mode, size, texLevels)
+                        : loadImage(ring, buffer, mode, size, texLevels);
+            }
+            if (texture == 0) {
+                Log::general << Log::MessageType::Warning
+                             << "Failed to stream texture "
+                             << request->path.c_str() << Log::Operation::Endl;
+
+                std::lock_guard<std::mutex> lock(request->mutex);
+                request->state = StreamRequest::State::Failed;
+                continue;
+            }
+
+            // Flushing makes the fence visible to the other contexts
+            auto* fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+
+            std::lock_guard<std::mutex> lock(request->mutex);
+            request->state   = StreamRequest::State::Uploaded;
+            request->texture = texture;
+            request->size    = size;
+            request->levels  = texLevels;
+            request->fence   = fence;
+            if (request->cancelled) {
+                release(*request);
+            }
+        }
+
+        for (auto& range : ring.inFlight) {
+            glDeleteSync(range.fence);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    streamer->context->setCurrent(false);
+}
+}
@@ -0,0 +1,97 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_TEXTURESTREAMER_HPP
+#define SGE_TEXTURESTREAMER_HPP
+
+#include <SGE/Texture.hpp>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace sge {
+/**
+ * \brief Streamed texture request
+ *
+ *
+ * Shared between the texture waiting for it and the loader thread.
+ */
+struct StreamRequest {
+    enum class State {
+        Queued,  ///< Waiting to be decoded and uploaded
+        Uploaded,///< Upload issued, ready once the fence signals
+        Failed   ///< Decoding failed or the streamer was shut down
+    };
+
+    std::string path;              ///< Path to the virtual file
+    Texture::MipmapMode mipmapMode;///< How the mip chain is created
+    std::mutex mutex;              ///< Guards the members below
+    State state;                   ///< Progress of the request
+    bool cancelled;                ///< The texture no longer wants the result
+    unsigned int texture;          ///< OpenGL texture name
+    glm::uvec2 size;               ///< Texture size
+    unsigned int levels;           ///< Number of mipmap levels of the texture
+    void* fence;                   ///< Fence of the upload (GLsync)
+};
+
+/**
+ * \brief Texture streamer
+ *
+ *
+ * Decodes images, or reads compressed containers, and uploads them on a
+ * loader thread, which has its own context sharing objects with the others.
+ * Uploads go through a persistently mapped pixel unpack buffer, so the loader
+ * thread never waits for the driver to copy client memory.
+ */
+class TextureStreamer {
+public:
+    /**
+     * \brief Queue texture load
+     *
+     *
+     * Starts the loader thread on the first call, which must happen on the
+     * main thread.
+     * \param path Path to the virtual file to load
+     * \param mipmapMode How the mip chain is created
+     * \return Request tracking the load
+     */
+    static std::shared_ptr<StreamRequest>
+    enqueue(const char* path, Texture::MipmapMode mipmapMode);
+
+    /**
+     * \brief Stop the loader thread
+     *
+     *
+     * Fails the queued requests, joins the loader thread and destroys its
+     * context. Must be called on the main thread.
+     */
+    static void shutdown();
+
+    /**
+     * \brief Release uploaded texture
+     *
+     *
+     * Deletes the texture and fence of an uploaded request nobody adopted.
+     * The request mutex must be locked.
+     * \param request Request to release
+     */
+    static void release(StreamRequest& request);
+
+private:
+    static void run();
+};
+}
+
+#endif//SGE_TEXTURESTREAMER_HPP
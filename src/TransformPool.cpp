@@ -0,0 +1,401 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/TransformPool.hpp>
+#include <SGE/Application.hpp>
+#include <SGE/JobSystem.hpp>
+#include "SimdConfig.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr std::size_t updateGrain = 4096;
+
+struct PoolData {
+    std::vector<std::uint32_t> indices;
+    std::vector<std::uint32_t> handles;
+    std::vector<std::uint32_t> freeHandles;
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> originX;
+    std::vector<float> originY;
+    std::vector<float> originZ;
+    std::vector<float> scaleX;
+    std::vector<float> scaleY;
+    std::vector<float> scaleZ;
+    std::vector<float> rotationX;
+    std::vector<float> rotationY;
+    std::vector<float> rotationZ;
+    std::vector<float> cosZ;
+    std::vector<float> sinZ;
+    std::vector<std::uint8_t> dirty;
+    std::vector<glm::mat4> matrices;
+    std::vector<std::uint32_t> revisions;// Indexed by handle, kept on reuse
+};
+
+float wrapDegrees(const float degrees) {
+    const auto wrapped = std::fmod(degrees, 360.0f);
+
+    return wrapped < 0.0f ? wrapped + 360.0f : wrapped;
+}
+
+void markDirty(PoolData& data, const std::uint32_t handle) {
+    data.dirty[data.indices[handle]] = 1;
+    data.revisions[handle]++;
+}
+
+// Same matrix as Transformable::getTransform
+void updateOne(PoolData& data, const std::size_t i) {
+    auto& m = data.matrices[i];
+
+    if (data.rotationX[i] == 0.0f && data.rotationY[i] == 0.0f) {
+        const auto c = data.cosZ[i];
+        const auto s = data.sinZ[i];
+
+        m       = glm::mat4(1.0f);
+        m[0][0] = c * data.scaleX[i];
+        m[0][1] = s * data.scaleX[i];
+        m[1][0] = -s * data.scaleY[i];
+        m[1][1] = c * data.scaleY[i];
+        m[2][2] = data.scaleZ[i];
+        m[3][0] = data.positionX[i] + data.originX[i] -
+                  (c * data.originX[i] - s * data.originY[i]);
+        m[3][1] = data.positionY[i] + data.originY[i] -
+                  (s * data.originX[i] + c * data.originY[i]);
+        m[3][2] = data.positionZ[i];
+    } else {
+        const glm::vec3 origin(
+            data.originX[i], data.originY[i], data.originZ[i]);
+
+        m = glm::mat4(1.0f);
+        m = glm::translate(
+            m,
+            glm::vec3(data.positionX[i], data.positionY[i], data.positionZ[i]));
+        m = glm::translate(m, origin);
+        m = glm::rotate(m,
+                        glm::radians(data.rotationX[i]),
+                        glm::vec3(1.0f, 0.0f, 0.0f));
+        m = glm::rotate(m,
+                        glm::radians(data.rotationY[i]),
+                        glm::vec3(0.0f, 1.0f, 0.0f));
+        m = glm::rotate(m,
+                        glm::radians(data.rotationZ[i]),
+                        glm::vec3(0.0f, 0.0f, 1.0f));
+        m = glm::translate(m, -origin);
+        m = glm::scale(
+            m, glm::vec3(data.scaleX[i], data.scaleY[i], data.scaleZ[i]));
+    }
+
+    data.dirty[i] = 0;
+}
+
+#ifdef SGE_SSE
+// Computes the z-only matrices of four consecutive transforms, one per lane,
+// then transposes the lanes into matrix columns
+void updateFour(PoolData& data, const std::size_t i) {
+    const auto c  = _mm_loadu_ps(&data.cosZ[i]);
+    const auto s  = _mm_loadu_ps(&data.sinZ[i]);
+    const auto sx = _mm_loadu_ps(&data.scaleX[i]);
+    const auto sy = _mm_loadu_ps(&data.scaleY[i]);
+    const auto ox = _mm_loadu_ps(&data.originX[i]);
+    const auto oy = _mm_loadu_ps(&data.originY[i]);
+    const auto px = _mm_loadu_ps(&data.positionX[i]);
+    const auto py = _mm_loadu_ps(&data.positionY[i]);
+    const auto pz = _mm_loadu_ps(&data.positionZ[i]);
+    const auto zero = _mm_setzero_ps();
+
+    auto m00 = _mm_mul_ps(c, sx);
+    auto m01 = _mm_mul_ps(s, sx);
+    auto m10 = _mm_sub_ps(zero, _mm_mul_ps(s, sy));
+    auto m11 = _mm_mul_ps(c, sy);
+    auto tx  = _mm_sub_ps(_mm_add_ps(px, ox),
+                         _mm_sub_ps(_mm_mul_ps(c, ox), _mm_mul_ps(s, oy)));
+    auto ty  = _mm_sub_ps(_mm_add_ps(py, oy),
+                         _mm_add_ps(_mm_mul_ps(s, ox), _mm_mul_ps(c, oy)));
+    auto tz  = pz;
+    auto tw  = _mm_set1_ps(1.0f);
+
+    _MM_TRANSPOSE4_PS(m00, m01, m10, m11);
+    _MM_TRANSPOSE4_PS(tx, ty, tz, tw);
+
+    const __m128 rotation[]    = {m00, m01, m10, m11};
+    const __m128 translation[] = {tx, ty, tz, tw};
+    for (std::size_t j = 0; j < 4; j++) {
+        auto* m = &data.matrices[i + j][0][0];
+
+        _mm_storeu_ps(m, _mm_movelh_ps(rotation[j], zero));
+        _mm_storeu_ps(m + 4, _mm_movehl_ps(zero, rotation[j]));
+        _mm_storeu_ps(m + 8, _mm_setr_ps(0.0f, 0.0f, data.scaleZ[i + j], 0.0f));
+        _mm_storeu_ps(m + 12, translation[j]);
+        data.dirty[i + j] = 0;
+
+        if (data.rotationX[i + j] != 0.0f || data.rotationY[i + j] != 0.0f) {
+            updateOne(data, i + j);
+        }
+    }
+}
+#endif
+
+void updateRange(PoolData& data,
+                 const std::size_t begin,
+                 const std::size_t end) {
+    auto i = begin;
+
+#ifdef SGE_SSE
+    for (; i + 4 <= end; i += 4) {
+        if ((data.dirty[i] | data.dirty[i + 1] | data.dirty[i + 2] |
+             data.dirty[i + 3]) != 0) {
+            updateFour(data, i);
+        }
+    }
+#endif
+
+    for (; i < end; i++) {
+        if (data.dirty[i] != 0) {
+            updateOne(data, i);
+        }
+    }
+}
+
+template<typename T> void pushBack(std::vector<T>& values, const T& value) {
+    values.push_back(value);
+}
+
+template<typename T>
+void removeAt(std::vector<T>& values, const std::uint32_t index) {
+    values[index] = values.back();
+    values.pop_back();
+}
+}
+
+namespace sge {
+TransformPool::TransformPool() : m_data(nullptr) {
+    try {
+        m_data = new PoolData;
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+TransformPool::~TransformPool() {
+    delete static_cast<PoolData*>(m_data);
+}
+
+TransformPool::Handle TransformPool::create() {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = static_cast<std::uint32_t>(data->handles.size());
+    Handle handle    = 0;
+
+    try {
+        if (data->freeHandles.empty()) {
+            handle = static_cast<Handle>(data->indices.size());
+            data->indices.push_back(index);
+            data->revisions.push_back(0);
+        } else {
+            handle = data->freeHandles.back();
+            data->freeHandles.pop_back();
+            data->indices[handle] = index;
+        }
+
+        pushBack(data->handles, handle);
+        pushBack(data->positionX, 0.0f);
+        pushBack(data->positionY, 0.0f);
+        pushBack(data->positionZ, 0.0f);
+        pushBack(data->originX, 0.0f);
+        pushBack(data->originY, 0.0f);
+        pushBack(data->originZ, 0.0f);
+        pushBack(data->scaleX, 1.0f);
+        pushBack(data->scaleY, 1.0f);
+        pushBack(data->scaleZ, 1.0f);
+        pushBack(data->rotationX, 0.0f);
+        pushBack(data->rotationY, 0.0f);
+        pushBack(data->rotationZ, 0.0f);
+        pushBack(data->cosZ, 1.0f);
+        pushBack(data->sinZ, 0.0f);
+        pushBack(data->dirty, std::uint8_t(0));
+        pushBack(data->matrices, glm::mat4(1.0f));
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+    data->revisions[handle]++;
+
+    return handle;
+}
+
+void TransformPool::destroy(const Handle handle) {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    // The last transform takes the place of the destroyed one, keeping the
+    // arrays contiguous
+    data->indices[data->handles.back()] = index;
+    removeAt(data->handles, index);
+    removeAt(data->positionX, index);
+    removeAt(data->positionY, index);
+    removeAt(data->positionZ, index);
+    removeAt(data->originX, index);
+    removeAt(data->originY, index);
+    removeAt(data->originZ, index);
+    removeAt(data->scaleX, index);
+    removeAt(data->scaleY, index);
+    removeAt(data->scaleZ, index);
+    removeAt(data->rotationX, index);
+    removeAt(data->rotationY, index);
+    removeAt(data->rotationZ, index);
+    removeAt(data->cosZ, index);
+    removeAt(data->sinZ, index);
+    removeAt(data->dirty, index);
+    removeAt(data->matrices, index);
+
+    try {
+        data->freeHandles.push_back(handle);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+}
+
+void TransformPool::setOrigin(const Handle handle, const glm::vec3& origin) {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    data->originX[index] = origin.x;
+    data->originY[index] = origin.y;
+    data->originZ[index] = origin.z;
+    markDirty(*data, handle);
+}
+
+void TransformPool::setPosition(const Handle handle,
+                                const glm::vec3& position) {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    data->positionX[index] = position.x;
+    data->positionY[index] = position.y;
+    data->positionZ[index] = position.z;
+    markDirty(*data, handle);
+}
+
+void TransformPool::setPositions(const Handle* handles,
+                                 const glm::vec3* positions,
+                                 const std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        setPosition(handles[i], positions[i]);
+    }
+}
+
+void TransformPool::setScale(const Handle handle, const glm::vec3& factor) {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    data->scaleX[index] = factor.x;
+    data->scaleY[index] = factor.y;
+    data->scaleZ[index] = factor.z;
+    markDirty(*data, handle);
+}
+
+void TransformPool::setRotation(const Handle handle, const glm::vec3& degrees) {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+    const auto z     = wrapDegrees(degrees.z);
+
+    data->rotationX[index] = wrapDegrees(degrees.x);
+    data->rotationY[index] = wrapDegrees(degrees.y);
+    data->rotationZ[index] = z;
+    data->cosZ[index]      = std::cos(glm::radians(z));
+    data->sinZ[index]      = std::sin(glm::radians(z));
+    markDirty(*data, handle);
+}
+
+void TransformPool::move(const Handle handle, const glm::vec3& offset) {
+    setPosition(handle, getPosition(handle) + offset);
+}
+
+glm::vec3 TransformPool::getOrigin(const Handle handle) const {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    return glm::vec3(
+        data->originX[index], data->originY[index], data->originZ[index]);
+}
+
+glm::vec3 TransformPool::getPosition(const Handle handle) const {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    return glm::vec3(data->positionX[index],
+                     data->positionY[index],
+                     data->positionZ[index]);
+}
+
+glm::vec3 TransformPool::getScale(const Handle handle) const {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    return glm::vec3(
+        data->scaleX[index], data->scaleY[index], data->scaleZ[index]);
+}
+
+glm::vec3 TransformPool::getRotation(const Handle handle) const {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    return glm::vec3(data->rotationX[index],
+                     data->rotationY[index],
+                     data->rotationZ[index]);
+}
+
+void TransformPool::updateAll() {
+    auto* data = static_cast<PoolData*>(m_data);
+
+    updateRange(*data, 0, data->handles.size());
+}
+
+void TransformPool::updateAll(JobSystem& jobSystem) {
+    auto* data = static_cast<PoolData*>(m_data);
+
+    // Job ranges start at multiples of 4, so every job but the last one runs
+    // only the four-wide kernel
+    jobSystem.parallelFor(
+        (data->handles.size() + 3) / 4,
+        updateGrain / 4,
+        [data](const std::size_t begin, const std::size_t end) {
+            updateRange(
+                *data, begin * 4, std::min(end * 4, data->handles.size()));
+        });
+}
+
+const glm::mat4& TransformPool::getTransform(const Handle handle) const {
+    auto* data       = static_cast<PoolData*>(m_data);
+    const auto index = data->indices[handle];
+
+    if (data->dirty[index] != 0) {
+        updateOne(*data, index);
+    }
+
+    return data->matrices[index];
+}
+
+std::uint32_t TransformPool::getRevision(const Handle handle) const {
+    auto* data = static_cast<PoolData*>(m_data);
+
+    return data->revisions[handle];
+}
+
+std::size_t TransformPool::getSize() const {
+    return static_cast<PoolData*>(m_data)->handles.size();
+}
+}
@@ -24,7 +24,7 @@ namespace sge {
 Transformable::Transformable()
     : m_origin(0.0f, 0.0f, 0.0f), m_position(0.0f, 0.0f, 0.0f),
       m_scale(1.0f, 1.0f, 1.0f), m_rotation(0.0f), m_transform(1.0f),
-      m_transformNeedsUpdate(true) {
+      m_transformNeedsUpdate(true), m_revision(0) {
 }
 
 void Transformable::setOrigin(const float x, const float y, const float z) {
@@ -32,6 +32,7 @@ void Transformable::setOrigin(const float x, const float y, const float z) {
     m_origin.y             = y;
     m_origin.z             = z;
     m_transformNeedsUpdate = true;
+    m_revision++;
 }
 
 void Transformable::setOrigin(const glm::vec3& origin) {
@@ -43,6 +44,7 @@ void Transformable::setPosition(const float x, const float y, const float z) {
     m_position.y           = y;
     m_position.z           = z;
     m_transformNeedsUpdate = true;
+    m_revision++;
 }
 
 void Transformable::setPosition(const glm::vec3& position) {
@@ -56,6 +58,7 @@ void Transformable::setScale(const float xFactor,
     m_scale.y              = yFactor;
     m_scale.z              = zFactor;
     m_transformNeedsUpdate = true;
+    m_revision++;
 }
 
 void Transformable::setScale(const glm::vec3& factor) {
@@ -80,6 +83,7 @@ void Transformable::setRotation(const float xDeg,
     }
 
     m_transformNeedsUpdate = true;
+    m_revision++;
 }
 
 void Transformable::setRotation(const glm::vec3& degrees) {
@@ -130,22 +134,46 @@ glm::vec3 Transformable::getRotation() const {
     return m_rotation;
 }
 
+std::uint32_t Transformable::getRevision() const {
+    return m_revision;
+}
+
 const glm::mat4& Transformable::getTransform() const {
     if (m_transformNeedsUpdate) {
-        m_transform            = glm::mat4(1.0f);
-        m_transform            = glm::translate(m_transform, m_position);
-        m_transform            = glm::translate(m_transform, m_origin);
-        m_transform            = glm::rotate(m_transform,
-                                  glm::radians(m_rotation.x),
-                                  glm::vec3(1.0f, 0.0f, 0.0f));
-        m_transform            = glm::rotate(m_transform,
-                                  glm::radians(m_rotation.y),
-                                  glm::vec3(0.0f, 1.0f, 0.0f));
-        m_transform            = glm::rotate(m_transform,
-                                  glm::radians(m_rotation.z),
-                                  glm::vec3(0.0f, 0.0f, 1.0f));
-        m_transform            = glm::translate(m_transform, -m_origin);
-        m_transform            = glm::scale(m_transform, m_scale);
+        if (m_rotation.x == 0.0f && m_rotation.y == 0.0f) {
+            // 2D objects only rotate around z, so the matrix is built
+            // directly instead of through the general 3D rotations
+            const auto angle = glm::radians(m_rotation.z);
+            const auto c     = std::cos(angle);
+            const auto s     = std::sin(angle);
+
+            m_transform       = glm::mat4(1.0f);
+            m_transform[0][0] = c * m_scale.x;
+            m_transform[0][1] = s * m_scale.x;
+            m_transform[1][0] = -s * m_scale.y;
+            m_transform[1][1] = c * m_scale.y;
+            m_transform[2][2] = m_scale.z;
+            m_transform[3][0] =
+                m_position.x + m_origin.x - (c * m_origin.x - s * m_origin.y);
+            m_transform[3][1] =
+                m_position.y + m_origin.y - (s * m_origin.x + c * m_origin.y);
+            m_transform[3][2] = m_position.z;
+        } else {
+            m_transform = glm::mat4(1.0f);
+            m_transform = glm::translate(m_transform, m_position);
+            m_transform = glm::translate(m_transform, m_origin);
+            m_transform = glm::rotate(m_transform,
+                                      glm::radians(m_rotation.x),
+                                      glm::vec3(1.0f, 0.0f, 0.0f));
+            m_transform = glm::rotate(m_transform,
+                                      glm::radians(m_rotation.y),
+                                      glm::vec3(0.0f, 1.0f, 0.0f));
+            m_transform = glm::rotate(m_transform,
+                                      glm::radians(m_rotation.z),
+                                      glm::vec3(0.0f, 0.0f, 1.0f));
+            m_transform = glm::translate(m_transform, -m_origin);
+            m_transform = glm::scale(m_transform, m_scale);
+        }
         m_transformNeedsUpdate = false;
     }
 
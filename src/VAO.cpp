@@ -29,7 +29,10 @@ VAO::VAO(VAO&& other) noexcept : m_id(other.m_id) {
 
 VAO::~VAO() {
     assert(Context::getCurrentContext());
-    glDeleteVertexArrays(1, &m_id);
+    if (m_id != 0) {
+        glDeleteVertexArrays(1, &m_id);
+        Context::objectDeleted();
+    }
 }
 
 VAO& VAO::operator=(VAO&& other) noexcept {
@@ -105,8 +108,19 @@ void VAO::setAttributeBinding(const unsigned int index,
     glVertexArrayAttribBinding(m_id, index, bindingIndex);
 }
 
+void VAO::setBindingDivisor(const unsigned int bindingIndex,
+                            const unsigned int divisor) const {
+    assert(Context::getCurrentContext());
+    glVertexArrayBindingDivisor(m_id, bindingIndex, divisor);
+}
+
+void VAO::setElementBuffer(const VBO& ebo) const {
+    assert(Context::getCurrentContext());
+    glVertexArrayElementBuffer(m_id, ebo.m_id);
+}
+
 void VAO::bind() const {
     assert(Context::getCurrentContext());
-    glBindVertexArray(m_id);
+    Context::getCurrentContext()->bindVertexArray(m_id);
 }
 }
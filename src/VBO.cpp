@@ -14,7 +14,10 @@
 
 #include <SGE/VBO.hpp>
 #include <SGE/Context.hpp>
+#include <SGE/Application.hpp>
+#include <algorithm>
 #include <cassert>
+#include <vector>
 #include <glad.h>
 
 namespace sge {
@@ -57,10 +60,23 @@ VBO::VBO(VBO&& other) noexcept
 VBO::~VBO() {
     assert(Context::getCurrentContext());
     unmapBuffer();
-    glDeleteBuffers(1, &m_id);
+    if (m_id != 0) {
+        glDeleteBuffers(1, &m_id);
+        Context::objectDeleted();
+    }
 }
 
 VBO& VBO::operator=(VBO&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    unmapBuffer();
+    if (m_id != 0) {
+        glDeleteBuffers(1, &m_id);
+        Context::objectDeleted();
+    }
+
     m_id              = other.m_id;
     m_allocated       = other.m_allocated;
     m_size            = other.m_size;
@@ -140,8 +156,65 @@ void VBO::flushChanges(std::size_t offset, std::size_t length) {
     glFlushMappedNamedBufferRange(m_id, offset, length);
 }
 
+void VBO::flushRanges(const Range* ranges, std::size_t count) {
+    assert(m_mapped && Context::getCurrentContext());
+
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1) {
+        glFlushMappedNamedBufferRange(m_id, ranges[0].offset, ranges[0].length);
+        return;
+    }
+
+    std::vector<Range> sorted;
+    try {
+        sorted.assign(ranges, ranges + count);
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    std::sort(sorted.begin(),
+              sorted.end(),
+              [](const Range& a, const Range& b) {
+                  return a.offset < b.offset;
+              });
+
+    auto current = sorted[0];
+    for (std::size_t i = 1; i < sorted.size(); i++) {
+        const auto& range = sorted[i];
+        if (range.offset <= current.offset + current.length) {
+            current.length = std::max(current.offset + current.length,
+                                      range.offset + range.length) -
+                             current.offset;
+        } else {
+            glFlushMappedNamedBufferRange(m_id, current.offset, current.length);
+            current = range;
+        }
+    }
+    glFlushMappedNamedBufferRange(m_id, current.offset, current.length);
+}
+
 void VBO::bindElementArray() {
     assert(Context::getCurrentContext());
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+    Context::getCurrentContext()->bindElementBuffer(m_id);
+}
+
+void VBO::bindShaderStorage(const unsigned int index,
+                            const std::size_t offset,
+                            const std::size_t length) {
+    assert(Context::getCurrentContext());
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, index, m_id, offset, length);
+}
+
+void VBO::bindDrawIndirect() {
+    assert(Context::getCurrentContext());
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_id);
+}
+
+void VBO::bindPixelUnpack() {
+    assert(Context::getCurrentContext());
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_id);
 }
 }
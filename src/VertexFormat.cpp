@@ -0,0 +1,79 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/VertexFormat.hpp>
+#include <cstddef>
+
+namespace {
+void bindAttributes(const sge::VAO& vao, const unsigned int bindingIndex) {
+    for (unsigned int i = 0; i < 4; i++) {
+        vao.enableAttribute(i);
+        vao.setAttributeBinding(i, bindingIndex);
+    }
+}
+}
+
+namespace sge {
+static_assert(sizeof(PackedVertex) == 24, "Packed vertices must be 24 bytes");
+
+void VertexFormat<Vertex>::configure(const VAO& vao,
+                                     const unsigned int bindingIndex) {
+    bindAttributes(vao, bindingIndex);
+    vao.setAttributeFormat(0,
+                           3,
+                           VAO::Data::Float,
+                           false,
+                           offsetof(Vertex, pos));
+    vao.setAttributeFormat(1,
+                           4,
+                           VAO::Data::UnsignedByte,
+                           true,
+                           offsetof(Vertex, tint));
+    vao.setAttributeFormat(2,
+                           2,
+                           VAO::Data::Float,
+                           false,
+                           offsetof(Vertex, texPos));
+    vao.setAttributeFormat(3,
+                           1,
+                           VAO::Data::Float,
+                           false,
+                           offsetof(Vertex, texUnit));
+}
+
+void VertexFormat<PackedVertex>::configure(const VAO& vao,
+                                           const unsigned int bindingIndex) {
+    bindAttributes(vao, bindingIndex);
+    vao.setAttributeFormat(0,
+                           3,
+                           VAO::Data::Float,
+                           false,
+                           offsetof(PackedVertex, pos));
+    vao.setAttributeFormat(1,
+                           4,
+                           VAO::Data::UnsignedByte,
+                           true,
+                           offsetof(PackedVertex, tint));
+    vao.setAttributeFormat(2,
+                           2,
+                           VAO::Data::HalfFloat,
+                           false,
+                           offsetof(PackedVertex, texPos));
+    vao.setAttributeFormat(3,
+                           1,
+                           VAO::Data::UnsignedShort,
+                           false,
+                           offsetof(PackedVertex, texUnit));
+}
+}
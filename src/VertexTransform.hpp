@@ -0,0 +1,237 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_VERTEXTRANSFORM_HPP
+#define SGE_VERTEXTRANSFORM_HPP
+
+#include <SGE/Vertex.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/packing.hpp>
+#include "SimdConfig.hpp"
+
+// Transforms vertices while copying them into a batch. Uses SSE2 when the
+// compiler targets it and glm otherwise. Batch vertices may be Vertex or
+// PackedVertex, everything but the position is converted by storeAttributes.
+namespace sge::batching {
+inline void
+storeAttributes(Vertex& dst, const Vertex& src, const float texUnit) {
+    dst.tint    = src.tint;
+    dst.texPos  = src.texPos;
+    dst.texUnit = texUnit;
+}
+
+inline void
+storeAttributes(PackedVertex& dst, const Vertex& src, const float texUnit) {
+    const auto texPos = glm::packHalf2x16(src.texPos);
+
+    dst.tint      = src.tint;
+    dst.texPos[0] = static_cast<std::uint16_t>(texPos & 0xffff);
+    dst.texPos[1] = static_cast<std::uint16_t>(texPos >> 16);
+    dst.texUnit   = static_cast<std::uint16_t>(texUnit);
+    dst.padding   = 0;
+}
+
+#ifdef SGE_SSE
+struct Matrix {
+    __m128 col[4];
+};
+
+inline Matrix loadMatrix(const glm::mat4& m) {
+    return {{_mm_loadu_ps(&m[0][0]),
+             _mm_loadu_ps(&m[1][0]),
+             _mm_loadu_ps(&m[2][0]),
+             _mm_loadu_ps(&m[3][0])}};
+}
+
+inline __m128 transform(const Matrix& m, const __m128 v) {
+    const auto x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+    const auto y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+    const auto z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+    const auto w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+    return _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(m.col[0], x), _mm_mul_ps(m.col[1], y)),
+        _mm_add_ps(_mm_mul_ps(m.col[2], z), _mm_mul_ps(m.col[3], w)));
+}
+
+inline Matrix multiply(const Matrix& a, const glm::mat4& b) {
+    return {{transform(a, _mm_loadu_ps(&b[0][0])),
+             transform(a, _mm_loadu_ps(&b[1][0])),
+             transform(a, _mm_loadu_ps(&b[2][0])),
+             transform(a, _mm_loadu_ps(&b[3][0]))}};
+}
+
+// Matrix with every element broadcast, to transform four vertices at once
+struct SplatMatrix {
+    __m128 m[4][4];
+};
+
+inline SplatMatrix splatMatrix(const Matrix& m) {
+    SplatMatrix s;
+    for (int c = 0; c < 4; c++) {
+        s.m[c][0] = _mm_shuffle_ps(m.col[c], m.col[c], _MM_SHUFFLE(0, 0, 0, 0));
+        s.m[c][1] = _mm_shuffle_ps(m.col[c], m.col[c], _MM_SHUFFLE(1, 1, 1, 1));
+        s.m[c][2] = _mm_shuffle_ps(m.col[c], m.col[c], _MM_SHUFFLE(2, 2, 2, 2));
+        s.m[c][3] = _mm_shuffle_ps(m.col[c], m.col[c], _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    return s;
+}
+
+// Checks if all vertices are outside the same plane of the clip volume
+inline bool
+isOutside(const Matrix& m, const Vertex* vertices, const std::size_t count) {
+    int outside = 0x3f;
+    for (std::size_t i = 0; i < count && outside != 0; i++) {
+        const auto& pos = vertices[i].pos;
+        const auto p    = transform(m, _mm_setr_ps(pos.x, pos.y, pos.z, 1.0f));
+        const auto w    = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+        const auto below =
+            _mm_movemask_ps(_mm_cmplt_ps(p, _mm_sub_ps(_mm_setzero_ps(), w)));
+        const auto above = _mm_movemask_ps(_mm_cmpgt_ps(p, w));
+
+        outside &= (below & 0x7) | (above & 0x7) << 3;
+    }
+
+    return outside != 0;
+}
+
+// Same test for four consecutive quads, one quad per lane. Returns a bit
+// per quad, set if the quad is outside
+inline unsigned int outsideQuads(const SplatMatrix& m, const Vertex* quads) {
+    const auto ones = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128 planes[6] = {ones, ones, ones, ones, ones, ones};
+
+    for (int corner = 0; corner < 4; corner++) {
+        const auto& a = quads[corner].pos;
+        const auto& b = quads[corner + 4].pos;
+        const auto& c = quads[corner + 8].pos;
+        const auto& d = quads[corner + 12].pos;
+        const auto x  = _mm_setr_ps(a.x, b.x, c.x, d.x);
+        const auto y  = _mm_setr_ps(a.y, b.y, c.y, d.y);
+        const auto z  = _mm_setr_ps(a.z, b.z, c.z, d.z);
+
+        __m128 clip[4];
+        for (int r = 0; r < 4; r++) {
+            clip[r] = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(m.m[0][r], x), _mm_mul_ps(m.m[1][r], y)),
+                _mm_add_ps(_mm_mul_ps(m.m[2][r], z), m.m[3][r]));
+        }
+
+        const auto negW = _mm_sub_ps(_mm_setzero_ps(), clip[3]);
+        for (int r = 0; r < 3; r++) {
+            planes[r] = _mm_and_ps(planes[r], _mm_cmplt_ps(clip[r], negW));
+            planes[r + 3] =
+                _mm_and_ps(planes[r + 3], _mm_cmpgt_ps(clip[r], clip[3]));
+        }
+    }
+
+    const auto outside =
+        _mm_or_ps(_mm_or_ps(_mm_or_ps(planes[0], planes[1]),
+                            _mm_or_ps(planes[2], planes[3])),
+                  _mm_or_ps(planes[4], planes[5]));
+
+    return static_cast<unsigned int>(_mm_movemask_ps(outside));
+}
+
+template<typename T>
+inline void
+storeVertex(T& dst, const Vertex& src, const Matrix& m, const float texUnit) {
+    const auto pos = transform(
+        m, _mm_setr_ps(src.pos.x, src.pos.y, src.pos.z, 1.0f));
+
+    _mm_storel_pi(reinterpret_cast<__m64*>(&dst.pos.x), pos);
+    _mm_store_ss(&dst.pos.z, _mm_movehl_ps(pos, pos));
+    storeAttributes(dst, src, texUnit);
+}
+#else
+using Matrix = glm::mat4;
+
+inline const Matrix& loadMatrix(const glm::mat4& m) {
+    return m;
+}
+
+inline Matrix multiply(const Matrix& a, const glm::mat4& b) {
+    return a * b;
+}
+
+using SplatMatrix = glm::mat4;
+
+inline const SplatMatrix& splatMatrix(const Matrix& m) {
+    return m;
+}
+
+// Checks if all vertices are outside the same plane of the clip volume
+inline bool
+isOutside(const Matrix& m, const Vertex* vertices, const std::size_t count) {
+    unsigned int outside = 0x3f;
+    for (std::size_t i = 0; i < count && outside != 0; i++) {
+        const auto p      = m * glm::vec4(vertices[i].pos, 1.0f);
+        unsigned int code = 0;
+
+        code |= p.x < -p.w ? 0x01 : 0;
+        code |= p.y < -p.w ? 0x02 : 0;
+        code |= p.z < -p.w ? 0x04 : 0;
+        code |= p.x > p.w ? 0x08 : 0;
+        code |= p.y > p.w ? 0x10 : 0;
+        code |= p.z > p.w ? 0x20 : 0;
+        outside &= code;
+    }
+
+    return outside != 0;
+}
+
+// Same test for four consecutive quads. Returns a bit per quad, set if the
+// quad is outside
+inline unsigned int outsideQuads(const SplatMatrix& m, const Vertex* quads) {
+    unsigned int outside = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+        outside |= isOutside(m, quads + i * 4, 4) ? 1u << i : 0;
+    }
+
+    return outside;
+}
+
+template<typename T>
+inline void
+storeVertex(T& dst, const Vertex& src, const Matrix& m, const float texUnit) {
+    dst.pos = m * glm::vec4(src.pos, 1.0f);
+    storeAttributes(dst, src, texUnit);
+}
+#endif
+
+template<typename T>
+inline void storeQuad(T* dst,
+                      const Vertex* src,
+                      const Matrix& m,
+                      const float texUnit) {
+    storeVertex(dst[0], src[0], m, texUnit);
+    storeVertex(dst[1], src[1], m, texUnit);
+    storeVertex(dst[2], src[2], m, texUnit);
+    storeVertex(dst[3], src[3], m, texUnit);
+}
+
+template<typename T>
+inline void copyVertices(T* dst,
+                         const Vertex* src,
+                         const std::size_t count,
+                         const float texUnit) {
+    for (std::size_t i = 0; i < count; i++) {
+        dst[i].pos = src[i].pos;
+        storeAttributes(dst[i], src[i], texUnit);
+    }
+}
+}
+
+#endif//SGE_VERTEXTRANSFORM_HPP
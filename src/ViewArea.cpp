@@ -0,0 +1,53 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ViewArea.hpp"
+#include <glm/matrix.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace sge::view {
+RectangleFloat getArea(const glm::mat4& transform) {
+    const auto inverse = glm::inverse(transform);
+    const glm::vec2 corners[] = {{-1.0f, -1.0f},
+                                 {1.0f, -1.0f},
+                                 {-1.0f, 1.0f},
+                                 {1.0f, 1.0f}};
+
+    float minX = INFINITY;
+    float minY = INFINITY;
+    float maxX = -INFINITY;
+    float maxY = -INFINITY;
+    for (const auto& corner : corners) {
+        auto front = inverse * glm::vec4(corner.x, corner.y, -1.0f, 1.0f);
+        auto back  = inverse * glm::vec4(corner.x, corner.y, 1.0f, 1.0f);
+        front      = front / front.w;
+        back       = back / back.w;
+
+        auto point    = front;
+        const auto dz = back.z - front.z;
+        if (std::abs(dz) > 1e-6f) {
+            point =
+                front + (back - front) * std::clamp(-front.z / dz, 0.0f, 1.0f);
+        }
+
+        minX = std::min(minX, point.x);
+        minY = std::min(minY, point.y);
+        maxX = std::max(maxX, point.x);
+        maxY = std::max(maxY, point.y);
+    }
+
+    return RectangleFloat(minX, minY, maxX - minX, maxY - minY);
+}
+}
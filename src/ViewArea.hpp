@@ -0,0 +1,35 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SGE_VIEWAREA_HPP
+#define SGE_VIEWAREA_HPP
+
+#include <SGE/Rectangle.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace sge::view {
+/**
+ * \brief Get view area
+ *
+ *
+ * Intersects the edges of the view frustum with the z = 0 plane to get the
+ * area seen through a transform. Edges which don't reach the plane are
+ * clamped to the near or far plane.
+ * \param transform Transform from the plane to clip space
+ * \return Bounding rectangle of the area on the plane
+ */
+RectangleFloat getArea(const glm::mat4& transform);
+}
+
+#endif//SGE_VIEWAREA_HPP
@@ -0,0 +1,582 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/VirtualTexture.hpp>
+#include <SGE/Application.hpp>
+#include <SGE/Camera.hpp>
+#include <SGE/Context.hpp>
+#include <SGE/Image.hpp>
+#include <SGE/JobSystem.hpp>
+#include <SGE/Log.hpp>
+#include <SGE/RenderTarget.hpp>
+#include <SGE/Shader.hpp>
+#include "ImageUtils.hpp"
+#include "ViewArea.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+using TileKey = std::uint64_t;
+
+constexpr unsigned int maxLoads = 8;// Tile loads in flight at a time
+
+struct TileLoad {
+    std::string path;                 ///< Path to the tile file
+    TileKey key;                      ///< Tile being loaded
+    unsigned int tileSize;            ///< Maximum size of the tile
+    bool active;                      ///< Submitted and not yet finished
+    std::uint64_t frame;              ///< Last update requesting the tile
+    bool loaded;                      ///< The tile was decoded
+    glm::uvec2 size;                  ///< Size of the tile
+    std::vector<unsigned char> pixels;///< Tile with its border
+    sge::JobCounter counter;          ///< Counter of the load job
+};
+
+struct CacheSlot {
+    TileKey key;                             ///< Tile held by the slot
+    bool used;                               ///< The slot holds a tile
+    std::uint64_t frame;                     ///< Last update using the tile
+    std::list<unsigned int>::iterator order; ///< Position in the LRU order
+};
+
+struct VirtualTextureData {
+    std::string directory;                             ///< Tile directory
+    sge::JobSystem* jobSystem;                         ///< Runs the loads
+    glm::uvec2 tiles;                                  ///< Level 0 tile count
+    unsigned int levels;                               ///< Tile level count
+    unsigned int cacheTiles;                           ///< Slots per side
+    std::uint64_t frame;                               ///< Update count
+    std::vector<CacheSlot> slots;                      ///< Cache slots
+    std::list<unsigned int> order;                     ///< Slots, MRU first
+    std::unordered_map<TileKey, unsigned int> resident;///< Tile slots
+    std::unordered_set<TileKey> missing;               ///< Failed tiles
+    std::unique_ptr<TileLoad[]> loads;                 ///< Loads in flight
+    std::vector<TileKey> requests;                     ///< Wanted tiles
+    std::vector<unsigned char> table;                  ///< Indirection table
+    unsigned int dirtyBegin;                           ///< First changed row
+    unsigned int dirtyEnd;                             ///< Past last one
+    const sge::Shader* shader;                         ///< Last draw shader
+    sge::Shader::UniformHandle tileSizeUniform;        ///< virtualTileSize
+    sge::Shader::UniformHandle widthUniform;           ///< virtualWidth
+    sge::Shader::UniformHandle heightUniform;          ///< virtualHeight
+};
+
+TileKey makeKey(const unsigned int level,
+                const unsigned int x,
+                const unsigned int y) {
+    return (TileKey(level) << 48) | (TileKey(y) << 24) | x;
+}
+
+unsigned int getLevel(const TileKey key) {
+    return static_cast<unsigned int>(key >> 48);
+}
+
+unsigned int getX(const TileKey key) {
+    return static_cast<unsigned int>(key & 0xFFFFFF);
+}
+
+unsigned int getY(const TileKey key) {
+    return static_cast<unsigned int>((key >> 24) & 0xFFFFFF);
+}
+
+void loadTile(void* data, std::size_t, std::size_t) {
+    auto& load = *static_cast<TileLoad*>(data);
+    sge::Image image;
+    sge::ImageLoader::Timing timing;
+
+    if (!sge::imageutils::readImage(load.path.c_str(), image, timing)) {
+        return;
+    }
+
+    const auto size = image.getSize();
+    if (size.x > load.tileSize || size.y > load.tileSize) {
+        return;
+    }
+
+    // The border keeps filtering from reading the neighbouring cache slots
+    try {
+        sge::imageutils::padPixels(image.getPixelData(), size, 1, load.pixels);
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+    load.size   = size;
+    load.loaded = true;
+}
+
+void setEntry(unsigned char* entry,
+              const VirtualTextureData& data,
+              const unsigned int slot,
+              const unsigned int level) {
+    entry[0] = static_cast<unsigned char>(slot % data.cacheTiles);
+    entry[1] = static_cast<unsigned char>(slot / data.cacheTiles);
+    entry[2] = static_cast<unsigned char>(level);
+    entry[3] = 255;
+}
+
+// Points the level 0 tiles under a newly resident tile to it, unless a finer
+// tile already covers them
+void coverTile(VirtualTextureData& data,
+               const TileKey key,
+               const unsigned int slot) {
+    const auto level = getLevel(key);
+    const auto left  = getX(key) << level;
+    const auto top   = getY(key) << level;
+    const auto right = std::min((getX(key) + 1) << level, data.tiles.x);
+    const auto down  = std::min((getY(key) + 1) << level, data.tiles.y);
+
+    for (auto y = top; y < down; y++) {
+        for (auto x = left; x < right; x++) {
+            auto* entry =
+                &data.table[(static_cast<std::size_t>(y) * data.tiles.x + x) *
+                            4];
+            if (entry[3] == 0 || entry[2] > level) {
+                setEntry(entry, data, slot, level);
+            }
+        }
+    }
+
+    data.dirtyBegin = std::min(data.dirtyBegin, top);
+    data.dirtyEnd   = std::max(data.dirtyEnd, down);
+}
+
+// Points the level 0 tiles drawn from an evicted tile to the finest resident
+// tile containing it
+void uncoverTile(VirtualTextureData& data, const TileKey key) {
+    const auto level = getLevel(key);
+    const auto left  = getX(key) << level;
+    const auto top   = getY(key) << level;
+    const auto right = std::min((getX(key) + 1) << level, data.tiles.x);
+    const auto down  = std::min((getY(key) + 1) << level, data.tiles.y);
+
+    auto parent      = data.resident.end();
+    auto parentLevel = level + 1;
+    for (; parentLevel < data.levels; parentLevel++) {
+        parent = data.resident.find(
+            makeKey(parentLevel, left >> parentLevel, top >> parentLevel));
+        if (parent != data.resident.end()) {
+            break;
+        }
+    }
+
+    for (auto y = top; y < down; y++) {
+        for (auto x = left; x < right; x++) {
+            auto* entry =
+                &data.table[(static_cast<std::size_t>(y) * data.tiles.x + x) *
+                            4];
+            if (entry[3] == 0 || entry[2] != level) {
+                continue;
+            }
+
+            if (parent != data.resident.end()) {
+                setEntry(entry, data, parent->second, parentLevel);
+            } else {
+                std::memset(entry, 0, 4);
+            }
+        }
+    }
+
+    data.dirtyBegin = std::min(data.dirtyBegin, top);
+    data.dirtyEnd   = std::max(data.dirtyEnd, down);
+}
+
+// Adds the tiles overlapping the visible rectangle, of the finest level whose
+// pixels are no smaller than the screen pixels, nearest to its center first
+void addVisibleTiles(VirtualTextureData& data,
+                     const unsigned int tileSize,
+                     const glm::uvec2& size,
+                     const glm::vec2& low,
+                     const glm::vec2& high,
+                     const float footprint) {
+    const auto left   = std::max(low.x, 0.0f);
+    const auto top    = std::max(low.y, 0.0f);
+    const auto right  = std::min(high.x, static_cast<float>(size.x));
+    const auto bottom = std::min(high.y, static_cast<float>(size.y));
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    auto level = footprint > 1.0f
+                     ? static_cast<unsigned int>(std::log2(footprint))
+                     : 0u;
+
+    level = std::min(level, data.levels - 1);
+
+    // Coarser levels are used when the visible tiles would not fit in the
+    // cache next to the tile of the last level
+    float extent;
+    unsigned int x0, y0, x1, y1;
+    for (;; level++) {
+        const auto tilesX = (data.tiles.x + (1u << level) - 1) >> level;
+        const auto tilesY = (data.tiles.y + (1u << level) - 1) >> level;
+
+        extent = std::ldexp(static_cast<float>(tileSize), level);
+        x0     = static_cast<unsigned int>(left / extent);
+        y0     = static_cast<unsigned int>(top / extent);
+        x1     = std::min(
+            static_cast<unsigned int>(std::ceil(right / extent)), tilesX);
+        y1     = std::min(
+            static_cast<unsigned int>(std::ceil(bottom / extent)), tilesY);
+
+        const auto count = static_cast<std::size_t>(x1 - x0) * (y1 - y0);
+        if (count < data.slots.size() || level + 1 == data.levels) {
+            break;
+        }
+    }
+
+    // The tile of the last level is always requested
+    if (level + 1 == data.levels) {
+        return;
+    }
+
+    const auto first = data.requests.size();
+    try {
+        for (auto y = y0; y < y1; y++) {
+            for (auto x = x0; x < x1; x++) {
+                data.requests.push_back(makeKey(level, x, y));
+            }
+        }
+    } catch (...) {
+        sge::Application::crashApplication("Bad alloc");
+    }
+
+    const auto centerX = (left + right) / 2.0f / extent - 0.5f;
+    const auto centerY = (top + bottom) / 2.0f / extent - 0.5f;
+    std::sort(data.requests.begin() + first,
+              data.requests.end(),
+              [centerX, centerY](const TileKey a, const TileKey b) {
+                  const auto ax = getX(a) - centerX;
+                  const auto ay = getY(a) - centerY;
+                  const auto bx = getX(b) - centerX;
+                  const auto by = getY(b) - centerY;
+
+                  return ax * ax + ay * ay < bx * bx + by * by;
+              });
+}
+}
+
+namespace sge {
+VirtualTexture::VirtualTexture(const char* directory,
+                               const glm::uvec2& size,
+                               const unsigned int tileSize,
+                               const unsigned int cacheTiles)
+    : m_size(size), m_tileSize(tileSize), m_batch(&m_cache, 1),
+      m_data(nullptr) {
+    assert(Context::getCurrentContext() != nullptr);
+    assert(directory != nullptr && tileSize > 0 && size.x > 0 && size.y > 0);
+
+    // Slot coordinates are stored in a byte of the indirection table
+    const auto slotSize = tileSize + 2;
+    const auto side     = std::max(
+        std::min({cacheTiles, Texture::getMaximumSize() / slotSize, 256u}),
+        1u);
+    const glm::uvec2 tiles((size.x + tileSize - 1) / tileSize,
+                           (size.y + tileSize - 1) / tileSize);
+
+    if (tiles.x > Texture::getMaximumSize() ||
+        tiles.y > Texture::getMaximumSize()) {
+        Application::crashApplication("Virtual texture is too large");
+    }
+
+    VirtualTextureData* data = nullptr;
+    try {
+        data   = new VirtualTextureData();
+        m_data = data;
+
+        data->directory = directory;
+        data->slots.resize(side * side);
+        data->loads.reset(new TileLoad[maxLoads]);
+        data->table.resize(static_cast<std::size_t>(tiles.x) * tiles.y * 4, 0);
+        for (unsigned int i = 0; i < side * side; i++) {
+            data->order.push_back(i);
+            data->slots[i] =
+                CacheSlot{0, false, 0, std::prev(data->order.end())};
+        }
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    data->jobSystem  = &Application::getJobSystem();
+    data->tiles      = tiles;
+    data->levels     = 1;
+    data->cacheTiles = side;
+    data->frame      = 0;
+    data->dirtyBegin = tiles.y;
+    data->dirtyEnd   = 0;
+    data->shader     = nullptr;
+    while ((1u << (data->levels - 1)) < std::max(tiles.x, tiles.y)) {
+        data->levels++;
+    }
+    for (unsigned int i = 0; i < maxLoads; i++) {
+        data->loads[i].active = false;
+    }
+
+    m_cache.setMipmapMode(Texture::MipmapMode::None);
+    m_cache.create(glm::uvec2(side * slotSize, side * slotSize));
+    m_cache.setWrapMode(Texture::WrapMode::ClampToEdge);
+    m_cache.setFilterMode(Texture::FilterMode::Linear);
+
+    m_table.setMipmapMode(Texture::MipmapMode::None);
+    m_table.create(tiles);
+    m_table.setWrapMode(Texture::WrapMode::ClampToEdge);
+    m_table.setFilterMode(Texture::FilterMode::Nearest);
+
+    m_batch.add(glm::vec2(0.0f, 0.0f),
+                glm::vec2(static_cast<float>(size.x),
+                          static_cast<float>(size.y)));
+}
+
+VirtualTexture::~VirtualTexture() {
+    auto* data = static_cast<VirtualTextureData*>(m_data);
+
+    // The loads write into the data until they finish
+    for (unsigned int i = 0; i < maxLoads; i++) {
+        if (data->loads[i].active) {
+            data->jobSystem->wait(data->loads[i].counter);
+        }
+    }
+
+    delete data;
+}
+
+void VirtualTexture::update(const RenderTarget& target) {
+    auto* data         = static_cast<VirtualTextureData*>(m_data);
+    const auto* camera = target.getCamera();
+    const auto view    = target.getViewport(*camera);
+
+    data->frame++;
+    data->requests.clear();
+    try {
+        data->requests.push_back(makeKey(data->levels - 1, 0, 0));
+    } catch (...) {
+        Application::crashApplication("Bad alloc");
+    }
+
+    if (view.width > 0 && view.height > 0) {
+        // View area on the image, in pixels with y pointing down
+        const auto area =
+            sge::view::getArea(camera->getTransform() * getTransform());
+        const glm::vec2 low(area.left, -(area.top + area.height));
+        const glm::vec2 high(area.left + area.width, -area.top);
+
+        const auto footprint =
+            std::max((high.x - low.x) / static_cast<float>(view.width),
+                     (high.y - low.y) / static_cast<float>(view.height));
+        addVisibleTiles(*data, m_tileSize, m_size, low, high, footprint);
+    }
+
+    // Requested tiles are kept in the cache, and their loads are not dropped
+    for (const auto key : data->requests) {
+        if (auto r = data->resident.find(key); r != data->resident.end()) {
+            auto& slot = data->slots[r->second];
+
+            slot.frame = data->frame;
+            data->order.splice(data->order.begin(), data->order, slot.order);
+            continue;
+        }
+
+        for (unsigned int i = 0; i < maxLoads; i++) {
+            if (data->loads[i].active && data->loads[i].key == key) {
+                data->loads[i].frame = data->frame;
+            }
+        }
+    }
+
+    finishLoads();
+
+    for (const auto key : data->requests) {
+        if (data->resident.count(key) != 0 || data->missing.count(key) != 0) {
+            continue;
+        }
+
+        const auto* begin = data->loads.get();
+        const auto* end   = begin + maxLoads;
+        if (std::find_if(begin, end, [key](const TileLoad& load) {
+                return load.active && load.key == key;
+            }) != end) {
+            continue;
+        }
+
+        if (!startLoad(key)) {
+            break;
+        }
+    }
+
+    // Jobs only run while waiting for them without worker threads
+    if (data->jobSystem->getWorkerCount() == 0) {
+        for (unsigned int i = 0; i < maxLoads; i++) {
+            if (data->loads[i].active) {
+                data->jobSystem->wait(data->loads[i].counter);
+            }
+        }
+        finishLoads();
+    }
+
+    uploadTable();
+}
+
+const glm::uvec2& VirtualTexture::getSize() const {
+    return m_size;
+}
+
+unsigned int VirtualTexture::getTileSize() const {
+    return m_tileSize;
+}
+
+unsigned int VirtualTexture::getLevelCount() const {
+    return static_cast<VirtualTextureData*>(m_data)->levels;
+}
+
+std::size_t VirtualTexture::getResidentTileCount() const {
+    return static_cast<VirtualTextureData*>(m_data)->resident.size();
+}
+
+void VirtualTexture::draw(RenderTarget& target,
+                          RenderState renderState) const {
+    assert(renderState.shader != nullptr);
+    auto* data   = static_cast<VirtualTextureData*>(m_data);
+    auto* shader = renderState.shader;
+
+    // Queued draws may use the same shader and bind their textures to unit 1
+    // too, so they have to be drawn before the uniforms and table are set
+    target.flushRenderQueue();
+
+    if (data->shader != shader) {
+        data->shader          = shader;
+        data->tileSizeUniform = shader->getUniformHandle("virtualTileSize");
+        data->widthUniform    = shader->getUniformHandle("virtualWidth");
+        data->heightUniform   = shader->getUniformHandle("virtualHeight");
+    }
+    shader->setUniform(data->tileSizeUniform, static_cast<int>(m_tileSize));
+    shader->setUniform(data->widthUniform, static_cast<int>(m_size.x));
+    shader->setUniform(data->heightUniform, static_cast<int>(m_size.y));
+    m_table.bind(1);
+
+    renderState.transform *= getTransform();
+    target.draw(m_batch, renderState);
+}
+
+void VirtualTexture::finishLoads() {
+    auto* data     = static_cast<VirtualTextureData*>(m_data);
+    const auto pad = m_tileSize + 2;
+
+    for (unsigned int i = 0; i < maxLoads; i++) {
+        auto& load = data->loads[i];
+        if (!load.active || !load.counter.isDone()) {
+            continue;
+        }
+
+        load.active = false;
+        if (!load.loaded) {
+            try {
+                data->missing.insert(load.key);
+            } catch (...) {
+                Application::crashApplication("Bad alloc");
+            }
+
+            Log::general << Log::MessageType::Warning
+                         << "Failed to load virtual texture tile: "
+                         << load.path.c_str() << Log::Operation::Endl;
+            continue;
+        }
+
+        // Tiles which went out of view while loading are dropped
+        if (load.frame != data->frame) {
+            continue;
+        }
+
+        const auto index = data->order.back();
+        auto& slot       = data->slots[index];
+        if (slot.used) {
+            // Every slot holds a tile in view
+            if (slot.frame == data->frame) {
+                continue;
+            }
+
+            data->resident.erase(slot.key);
+            uncoverTile(*data, slot.key);
+        }
+
+        m_cache.update(load.pixels.data(),
+                       glm::uvec2(load.size.x + 2, load.size.y + 2),
+                       glm::uvec2(index % data->cacheTiles * pad,
+                                  index / data->cacheTiles * pad));
+
+        slot.key   = load.key;
+        slot.used  = true;
+        slot.frame = data->frame;
+        data->order.splice(data->order.begin(), data->order, slot.order);
+        try {
+            data->resident.emplace(load.key, index);
+        } catch (...) {
+            Application::crashApplication("Bad alloc");
+        }
+        coverTile(*data, load.key, index);
+    }
+}
+
+bool VirtualTexture::startLoad(const std::uint64_t key) {
+    auto* data = static_cast<VirtualTextureData*>(m_data);
+
+    for (unsigned int i = 0; i < maxLoads; i++) {
+        auto& load = data->loads[i];
+        if (load.active) {
+            continue;
+        }
+
+        try {
+            load.path = data->directory + '/' +
+                        std::to_string(getLevel(key)) + '/' +
+                        std::to_string(getX(key)) + '_' +
+                        std::to_string(getY(key)) + ".png";
+        } catch (...) {
+            Application::crashApplication("Bad alloc");
+        }
+        load.key      = key;
+        load.tileSize = m_tileSize;
+        load.active   = true;
+        load.frame    = data->frame;
+        load.loaded   = false;
+        data->jobSystem->submit(loadTile, &load, 0, 1, &load.counter);
+
+        return true;
+    }
+
+    return false;
+}
+
+void VirtualTexture::uploadTable() {
+    auto* data = static_cast<VirtualTextureData*>(m_data);
+    if (data->dirtyBegin >= data->dirtyEnd) {
+        return;
+    }
+
+    // Whole rows are uploaded, as they are contiguous in the table
+    m_table.update(data->table.data() + static_cast<std::size_t>(
+                                            data->dirtyBegin) *
+                                            data->tiles.x * 4,
+                   glm::uvec2(data->tiles.x, data->dirtyEnd - data->dirtyBegin),
+                   glm::uvec2(0, data->dirtyBegin));
+
+    data->dirtyBegin = data->tiles.y;
+    data->dirtyEnd   = 0;
+}
+}
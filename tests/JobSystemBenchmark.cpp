@@ -0,0 +1,110 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/JobSystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Times parallelFor over particle-like data for a growing number of workers.
+// The data comes from a fixed seed, so runs on the same machine compare.
+namespace {
+constexpr std::uint32_t seed     = 1234;
+constexpr std::size_t itemCount  = 1 << 20;
+constexpr std::size_t grain      = 4096;
+constexpr unsigned int runCount  = 15;
+constexpr unsigned int stepCount = 8;
+
+struct Item {
+    float x, y;
+    float vx, vy;
+};
+
+void step(std::vector<Item>& items,
+          const std::size_t begin,
+          const std::size_t end) {
+    for (auto i = begin; i < end; i++) {
+        auto& item = items[i];
+        for (unsigned int s = 0; s < stepCount; s++) {
+            item.vx += -item.x * 0.01f + std::sin(item.y) * 0.001f;
+            item.vy += -item.y * 0.01f + std::cos(item.x) * 0.001f;
+            item.x += item.vx * 0.016f;
+            item.y += item.vy * 0.016f;
+        }
+    }
+}
+}
+
+int main() {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> velocity(-1.0f, 1.0f);
+    std::vector<Item> start(itemCount);
+    for (auto& item : start) {
+        item = {position(random),
+                position(random),
+                velocity(random),
+                velocity(random)};
+    }
+
+    const auto maxWorkers =
+        std::max(1u, std::thread::hardware_concurrency()) - 1;
+    std::printf("%zu items, grain %zu, median of %u runs\n",
+                itemCount,
+                grain,
+                runCount);
+
+    std::vector<unsigned int> workerCounts = {0};
+    for (unsigned int workers = 1; workers < maxWorkers; workers *= 2) {
+        workerCounts.push_back(workers);
+    }
+    if (maxWorkers > 0) {
+        workerCounts.push_back(maxWorkers);
+    }
+
+    double baseline = 0.0;
+    for (const auto workers : workerCounts) {
+        sge::JobSystem jobs(workers);
+        std::vector<double> times;
+
+        for (unsigned int r = 0; r < runCount; r++) {
+            auto items       = start;
+            const auto job   = [&](const std::size_t b, const std::size_t e) {
+                step(items, b, e);
+            };
+            const auto begin = std::chrono::steady_clock::now();
+
+            jobs.parallelFor(items.size(), grain, job);
+            times.push_back(std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - begin)
+                                .count());
+        }
+
+        std::sort(times.begin(), times.end());
+        const auto median = times[runCount / 2];
+        if (workers == 0) {
+            baseline = median;
+        }
+        std::printf("%2u workers: %8.3f ms, speedup %.2fx\n",
+                    workers,
+                    median,
+                    baseline / median);
+    }
+
+    return 0;
+}
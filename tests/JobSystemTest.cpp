@@ -0,0 +1,148 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/JobSystem.hpp>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Checks the job system without a window or OpenGL context. Every check runs
+// without workers, where jobs run on the waiting thread, and with a few
+// workers, where they are stolen between threads.
+namespace {
+constexpr unsigned int workerCounts[] = {0, 1, 3, 8};
+constexpr unsigned int repeats        = 50;
+
+int failures = 0;
+
+void check(const bool condition, const char* what, const unsigned int workers) {
+    if (!condition) {
+        std::printf("FAILED: %s (%u workers)\n", what, workers);
+        failures++;
+    }
+}
+
+// Every index of the range is visited exactly once, for ranges which are
+// empty, smaller than a grain, or not a multiple of it
+void testCoverage(sge::JobSystem& jobs, const unsigned int workers) {
+    const std::size_t counts[] = {0, 1, 63, 64, 65, 10007};
+    const std::size_t grains[] = {1, 64, 100000};
+
+    for (const auto count : counts) {
+        for (const auto grain : grains) {
+            std::unique_ptr<std::atomic<int>[]> visits(
+                new std::atomic<int>[count + 1]);
+            for (std::size_t i = 0; i <= count; i++) {
+                visits[i] = 0;
+            }
+
+            jobs.parallelFor(
+                count, grain, [&](const std::size_t b, const std::size_t e) {
+                    for (auto i = b; i < e; i++) {
+                        visits[i]++;
+                    }
+                });
+
+            bool once = visits[count] == 0;
+            for (std::size_t i = 0; i < count; i++) {
+                once = once && visits[i] == 1;
+            }
+            check(once, "parallelFor visits every index once", workers);
+        }
+    }
+}
+
+struct Stages {
+    std::vector<int> values;
+    std::atomic<bool> ordered;
+};
+
+void firstStage(void* data, const std::size_t begin, const std::size_t end) {
+    auto& stages = *static_cast<Stages*>(data);
+    for (auto i = begin; i < end; i++) {
+        stages.values[i] = static_cast<int>(i);
+    }
+}
+
+void secondStage(void* data, const std::size_t begin, const std::size_t end) {
+    auto& stages = *static_cast<Stages*>(data);
+    for (auto i = begin; i < end; i++) {
+        // The whole first stage must have finished, not only this range
+        if (stages.values[stages.values.size() - 1 - i] !=
+            static_cast<int>(stages.values.size() - 1 - i)) {
+            stages.ordered = false;
+        }
+    }
+}
+
+// Jobs with a dependency start only after every job of its counter finished
+void testDependency(sge::JobSystem& jobs, const unsigned int workers) {
+    for (unsigned int r = 0; r < repeats; r++) {
+        Stages stages;
+        stages.values.assign(4096, -1);
+        stages.ordered = true;
+
+        sge::JobCounter first;
+        sge::JobCounter second;
+        jobs.parallelFor(
+            stages.values.size(), 128, firstStage, &stages, &first);
+        jobs.parallelFor(
+            stages.values.size(), 128, secondStage, &stages, &second, &first);
+        jobs.wait(second);
+
+        check(first.isDone() && second.isDone(), "counters finish", workers);
+        check(stages.ordered, "dependent jobs run after the others", workers);
+    }
+}
+
+// Jobs may wait for jobs they submit themselves
+void testNestedWait(sge::JobSystem& jobs, const unsigned int workers) {
+    constexpr std::size_t outer = 16;
+    constexpr std::size_t inner = 1000;
+
+    for (unsigned int r = 0; r < repeats; r++) {
+        std::atomic<std::size_t> total(0);
+
+        const auto count = [&](const std::size_t b, const std::size_t e) {
+            total += e - b;
+        };
+        const auto spawn = [&](const std::size_t b, const std::size_t e) {
+            for (auto i = b; i < e; i++) {
+                jobs.parallelFor(inner, 10, count);
+            }
+        };
+        jobs.parallelFor(outer, 1, spawn);
+
+        check(total == outer * inner, "nested waits finish", workers);
+    }
+}
+}
+
+int main() {
+    for (const auto workers : workerCounts) {
+        sge::JobSystem jobs(workers);
+
+        check(jobs.getWorkerCount() == workers, "worker count", workers);
+        testCoverage(jobs, workers);
+        testDependency(jobs, workers);
+        testNestedWait(jobs, workers);
+    }
+
+    if (failures == 0) {
+        std::printf("All job system checks passed\n");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+// Copyright 2020 Dan Sirbu
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <SGE/SceneIndex.hpp>
+#include <SGE/Sprite.hpp>
+#include <cstdio>
+
+// Checks that sprites are found where they are drawn, without a window or
+// OpenGL context. Sprites extend down from their position, so a sprite at
+// (100, 50) with a height of 16 covers y in [34, 50].
+namespace {
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+    if (!condition) {
+        std::printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+bool finds(sge::SceneIndex& index,
+           const sge::RectangleFloat& area,
+           const sge::Drawable& drawable) {
+    const auto count = index.query(area);
+    return count == 1 && index.getQueryResults()[0] == &drawable;
+}
+}
+
+int main() {
+    sge::Sprite sprite(nullptr,
+                       sge::RectangleFloat(0.0f, 0.0f, 1.0f, 1.0f),
+                       glm::vec2(32.0f, 16.0f));
+    sprite.setPosition(100.0f, 50.0f);
+
+    const sge::RectangleFloat inside(90.0f, 30.0f, 20.0f, 10.0f);
+    const sge::RectangleFloat above(90.0f, 51.0f, 20.0f, 10.0f);
+
+    const auto bounds = sprite.getWorldBounds();
+    check(bounds.left == 100.0f && bounds.top == 50.0f &&
+              bounds.width == 32.0f && bounds.height == 16.0f,
+          "world bounds have their top at the largest y");
+
+    sge::SceneIndex world;
+    world.insert(sprite, false);
+    check(finds(world, inside, sprite),
+          "query finds a sprite inserted with its world bounds");
+    check(world.query(above) == 0, "query skips the area above a sprite");
+
+    sge::SceneIndex tracked;
+    tracked.insert(sprite);
+    check(finds(tracked, inside, sprite), "query finds an inserted sprite");
+    check(tracked.query(above) == 0,
+          "query skips the area above an inserted sprite");
+
+    sge::SceneIndex moving;
+    const auto handle = moving.insert(sprite);
+    sprite.move(0.0f, 20.0f);
+    moving.update();
+    check(finds(moving, inside, sprite),
+          "update keeps an unmarked sprite in its cells");
+    moving.markMoved(handle);
+    moving.update();
+    check(finds(moving, above, sprite), "update moves a marked sprite");
+    check(moving.query(inside) == 0,
+          "update removes a marked sprite from its old cells");
+
+    if (failures == 0) {
+        std::printf("All scene index checks passed\n");
+    }
+
+    return failures == 0 ? 0 : 1;
+}